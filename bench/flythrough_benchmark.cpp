@@ -0,0 +1,60 @@
+// Scripted fly-through without a window: slides the chunk view window one
+// chunk along +x at a time, waits for each step to generate and mesh, and
+// rebuilds a reused instance buffer the way the simulation thread does. Prints
+// allocator calls, chunk objects and peak RSS for the slides.
+//
+// Usage: flythrough_benchmark [slides]
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "chunk_manager.hpp"
+#include "memory_stats.hpp"
+
+namespace {
+    constexpr int DEFAULT_SLIDES = 40;
+
+    // Generate, mesh and stage everything the window at (chunkX, 0) needs
+    void loadWindow(ChunkManager& manager, int chunkX, std::vector<glm::mat4>& instances) {
+        manager.updateChunks(chunkX, 0);
+        while (!manager.isFullyLoaded()) {
+            if (manager.pollGeneratedChunks().empty()) {
+                std::this_thread::yield();
+            }
+        }
+
+        instances.clear();
+        for (Chunk* chunk : manager.getReadyChunks()) {
+            chunk->updateMesh(manager.getNeighbourhood(chunk->getChunkX(), chunk->getChunkZ()));
+            for (int section = 0; section < Chunk::SECTION_COUNT; section++) {
+                for (const auto& cube : chunk->getSectionMesh(section).cubes) {
+                    instances.push_back(glm::translate(glm::mat4(1.0f), cube.position));
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int slides = argc > 1 ? std::atoi(argv[1]) : DEFAULT_SLIDES;
+
+    Chunk::initializeNoise();
+    ChunkManager manager;
+    std::vector<glm::mat4> instances;
+    loadWindow(manager, 0, instances);
+
+    std::uint64_t allocationsBefore = MemoryStats::allocationCount();
+    for (int slide = 1; slide <= slides; slide++) {
+        loadWindow(manager, slide, instances);
+    }
+    std::uint64_t allocations = MemoryStats::allocationCount() - allocationsBefore;
+
+    std::cout << "Slides: " << slides << "\n"
+              << "Allocator calls during slides: " << allocations << " (" << allocations / std::max(slides, 1) << " per slide)\n"
+              << "Chunk objects allocated: " << manager.allocatedChunkCount() << "\n"
+              << "Peak RSS: " << MemoryStats::peakResidentBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+    return 0;
+}
@@ -2,14 +2,40 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 layout (location = 2) in mat4 instanceMatrix;
+// Per-face corner occlusion, diagonal flips and visibility (see Chunk::MeshCube)
+layout (location = 6) in uvec2 instanceShading;
+// The same vertex when its face is split along the other diagonal
+layout (location = 7) in vec3 aFlippedPos;
+layout (location = 8) in vec3 aFlippedColor;
+// face * 4 + corner for the normal and flipped split
+layout (location = 9) in ivec2 aFaceCorner;
 
 out vec3 vertexColor;
 
 uniform mat4 view;
 uniform mat4 projection;
+uniform bool water;
 
 void main()
 {
-    gl_Position = projection * view * instanceMatrix * vec4(aPos, 1.0);
-    vertexColor = aColor;
+    int face = aFaceCorner.x / 4;
+    if (((instanceShading.y >> uint(22 + face)) & 1u) == 0u) {
+        // Hidden face: collapse it so it produces no fragments
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        vertexColor = vec3(0.0);
+        return;
+    }
+
+    bool flipped = ((instanceShading.y >> uint(16 + face)) & 1u) != 0u;
+    vec3 position = flipped ? aFlippedPos : aPos;
+    vec3 color = flipped ? aFlippedColor : aColor;
+    int faceCorner = flipped ? aFaceCorner.y : aFaceCorner.x;
+
+    uint bits = faceCorner < 16 ? instanceShading.x : instanceShading.y;
+    float occlusion = float((bits >> uint(2 * (faceCorner % 16))) & 3u);
+
+    gl_Position = projection * view * instanceMatrix * vec4(position, 1.0);
+    // Water reuses the cube's per-corner shading, tinted blue
+    vec3 baseColor = water ? vec3(0.1, 0.3, 0.8) * (0.6 + 0.4 * color.g) : color;
+    vertexColor = baseColor * (0.4 + 0.2 * occlusion);
 }
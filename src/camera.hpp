@@ -52,6 +52,9 @@ public:
     // processes input received from a mouse input system. Expects the offset value in both the x and y direction.
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true);
 
+    // sets the Euler angles directly, e.g. to mirror another camera's orientation
+    void SetOrientation(float yaw, float pitch);
+
     // processes input received from a mouse scroll-wheel event. Only requires input on the vertical wheel-axis
     void ProcessMouseScroll(float yoffset);
 
@@ -1,4 +1,94 @@
 #include "chunk.hpp"
+#include "memory_stats.hpp"
+#include "scratch_arena.hpp"
+#include "geometry.hpp"
+#include <bit>
+
+namespace {
+
+// The mesher copies a section's rows plus a one-cube border into 64-bit masks,
+// with bit x + 1 holding column x so the border columns -1 and 32 fit too
+constexpr int PADDED_DEPTH = Chunk::CHUNK_DEPTH + 2;
+constexpr int PADDED_HEIGHT = Chunk::SECTION_HEIGHT + 2;
+constexpr std::uint64_t ROW_MASK = 0xFFFFFFFFull;
+
+// Bit layout of MeshCube::shading
+constexpr int FLIP_SHIFT = 48;
+constexpr int VISIBLE_SHIFT = 54;
+
+// Ambient occlusion of a face depends only on the 3x3 cubes in front of it.
+// Per face, that plane is a 9-bit mask (bit u + 3 * v for offsets -1..1 along
+// the face's two tangent axes in xyz order), and this table maps each mask to
+// the face's four 2-bit corner values (bits 0-7) and its diagonal flip (bit 8).
+constexpr auto FACE_OCCLUSION = [] {
+    std::array<std::array<std::uint16_t, 512>, 6> table{};
+    for (int face = 0; face < 6; face++) {
+        const int* normal = cubeFaceNormals[face];
+        int normalAxis = normal[0] != 0 ? 0 : (normal[1] != 0 ? 1 : 2);
+        int tangent1 = normalAxis == 0 ? 1 : 0;
+        int tangent2 = normalAxis == 2 ? 1 : 2;
+        for (int plane = 0; plane < 512; plane++) {
+            auto solid = [plane](int u, int v) { return (plane >> ((u + 1) + 3 * (v + 1))) & 1; };
+            int occlusion[4];
+            std::uint16_t entry = 0;
+            for (int corner = 0; corner < 4; corner++) {
+                // The two cubes beside the corner and the one diagonally across it
+                const float* position = &cubeVertices[cubeFaces[face][corner] * 6];
+                int u = position[tangent1] > 0 ? 1 : -1;
+                int v = position[tangent2] > 0 ? 1 : -1;
+                int side1 = solid(u, 0);
+                int side2 = solid(0, v);
+                int diagonal = solid(u, v);
+                occlusion[corner] = side1 && side2 ? 0 : 3 - (side1 + side2 + diagonal);
+                entry |= occlusion[corner] << (corner * 2);
+            }
+            // Split the quad along the diagonal that interpolates occlusion evenly
+            if (occlusion[0] + occlusion[2] < occlusion[1] + occlusion[3]) {
+                entry |= 1 << 8;
+            }
+            table[face][plane] = entry;
+        }
+    }
+    return table;
+}();
+
+// Row z (-1..32) at height y of a neighbourhood, padded with the bordering columns
+std::uint64_t paddedRow(const Chunk::Neighbourhood& neighbours, int y, int z) {
+    int dz = z < 0 ? 0 : (z >= Chunk::CHUNK_DEPTH ? 2 : 1);
+    int localZ = z - (dz - 1) * Chunk::CHUNK_DEPTH;
+    auto row = [&](int dx) -> std::uint64_t {
+        const Chunk* chunk = neighbours.chunks[dx][dz];
+        return chunk ? chunk->getRow(y, localZ) : 0;
+    };
+    return (row(1) << 1) | (row(0) >> 31) | ((row(2) & 1) << 33);
+}
+
+// The 9-bit plane of cubes in front of a face of the cube at (x, y, z)
+std::uint32_t facePlane(const std::uint64_t* rows, int x, int y, int z, int face) {
+    const int* normal = cubeFaceNormals[face];
+    std::uint32_t plane = 0;
+    if (normal[0] != 0) {
+        // Tangents y and z: one bit from each of nine rows
+        int bit = x + 1 + normal[0];
+        for (int dz = 0; dz < 3; dz++) {
+            for (int dy = 0; dy < 3; dy++) {
+                plane |= static_cast<std::uint32_t>((rows[(y + dy) * PADDED_DEPTH + z + dz] >> bit) & 1) << (dy + 3 * dz);
+            }
+        }
+    } else {
+        // Tangents x and z (or x and y): three bits from each of three rows
+        const std::uint64_t* first = normal[1] != 0
+            ? rows + (y + 1 + normal[1]) * PADDED_DEPTH + z
+            : rows + y * PADDED_DEPTH + z + 1 + normal[2];
+        int stride = normal[1] != 0 ? 1 : PADDED_DEPTH;
+        for (int v = 0; v < 3; v++) {
+            plane |= static_cast<std::uint32_t>((first[v * stride] >> x) & 7) << (3 * v);
+        }
+    }
+    return plane;
+}
+
+} // namespace
 
 // Initialize static noise generator
 FastNoise::SmartNode<FastNoise::FractalFBm> Chunk::s_noiseGenerator = nullptr;
@@ -21,22 +111,53 @@ void Chunk::cleanupNoise() {
 }
 
 Chunk::Chunk(int chunkX, int chunkZ) 
-    : m_chunkX(chunkX), m_chunkZ(chunkZ), m_cubes(CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_DEPTH, false) {
+    : m_chunkX(chunkX), m_chunkZ(chunkZ), m_cubes(CHUNK_HEIGHT * CHUNK_DEPTH, 0) {
     
     // Initialize noise generator if not already initialized
     if (!s_noiseGenerator) {
         initializeNoise();
     }
-    
-    // Generate terrain using Perlin noise
-    generateTerrain();
+
+    MemoryStats::track(MemoryTag::Voxels, static_cast<std::int64_t>(m_cubes.capacity() * sizeof(std::uint32_t)));
+}
+
+Chunk::~Chunk() {
+    MemoryStats::track(MemoryTag::Voxels, -static_cast<std::int64_t>(m_cubes.capacity() * sizeof(std::uint32_t)));
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        MemoryStats::track(MemoryTag::Meshes, -meshBytes(m_sectionMeshes[section]));
+        if (m_water[section]) {
+            MemoryStats::track(MemoryTag::Voxels, -SECTION_VOLUME);
+        }
+    }
+}
+
+void Chunk::reset(int chunkX, int chunkZ) {
+    m_chunkX = chunkX;
+    m_chunkZ = chunkZ;
+    std::fill(m_cubes.begin(), m_cubes.end(), 0);
+    std::fill(std::begin(m_sectionSolidCounts), std::end(m_sectionSolidCounts), 0);
+    // Keep allocated water sections for reuse, just drain them
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        if (m_water[section]) {
+            std::fill(m_water[section].get(), m_water[section].get() + SECTION_VOLUME, 0);
+        }
+        m_sectionMeshes[section].cubes.clear();
+        m_sectionMeshes[section].water.clear();
+    }
+    m_dirtySections = ALL_SECTIONS;
+    m_dirtyWaterSections = ALL_SECTIONS;
 }
 
 void Chunk::generateTerrain() {
     // Clear existing blocks
-    std::fill(m_cubes.begin(), m_cubes.end(), false);
-    
-    // Generate new terrain
+    std::fill(m_cubes.begin(), m_cubes.end(), 0);
+    std::fill(std::begin(m_sectionSolidCounts), std::end(m_sectionSolidCounts), 0);
+
+    // Sample the heightmap into thread-local scratch memory first
+    ScratchArena& arena = ScratchArena::forThread();
+    ScratchArena::Scope scope(arena);
+    int* heights = arena.allocate<int>(CHUNK_WIDTH * CHUNK_DEPTH);
+
     for (int x = 0; x < CHUNK_WIDTH; x++) {
         for (int z = 0; z < CHUNK_DEPTH; z++) {
             // Get world coordinates for noise sampling
@@ -49,16 +170,30 @@ void Chunk::generateTerrain() {
             // Ensure height is within chunk boundaries
             height = std::min(height, CHUNK_HEIGHT - 1);
             height = std::max(height, 0);
-            
-            // Set all blocks from bottom to height as solid
+            heights[x + z * CHUNK_WIDTH] = height;
+        }
+    }
+
+    // Set all blocks from bottom to height as solid, a row bit at a time
+    for (int x = 0; x < CHUNK_WIDTH; x++) {
+        for (int z = 0; z < CHUNK_DEPTH; z++) {
+            int height = heights[x + z * CHUNK_WIDTH];
             for (int y = 0; y <= height; y++) {
-                setCube(x, y, z, true);
+                m_cubes[getRowIndex(y, z)] |= 1u << x;
             }
         }
     }
+
+    for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        for (int z = 0; z < CHUNK_DEPTH; z++) {
+            m_sectionSolidCounts[y / SECTION_HEIGHT] += std::popcount(m_cubes[getRowIndex(y, z)]);
+        }
+    }
+    m_dirtySections = ALL_SECTIONS;
+    m_dirtyWaterSections = ALL_SECTIONS;
 }
 
-int Chunk::getHeightAt(int worldX, int worldZ) const {
+int Chunk::getHeightAt(int worldX, int worldZ) {
     // Sample 2D noise at the world coordinates
     float noiseValue = s_noiseGenerator->GenSingle2D(worldX * 0.01f, worldZ * 0.01f, 0);
     
@@ -72,26 +207,137 @@ int Chunk::getHeightAt(int worldX, int worldZ) const {
     return baseHeight + static_cast<int>(noiseValue * heightVariation);
 }
 
-std::vector<glm::vec3> Chunk::generateCubePositions() const {
-    if (!m_positionsDirty) {
-        return m_cubePositions;
+int Chunk::updateMesh(const Neighbourhood& neighbours) const {
+    int changes = 0;
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        std::uint32_t bit = 1u << section;
+        if (m_dirtySections & bit) {
+            buildCubeMesh(section, neighbours, true);
+            changes |= CUBES_CHANGED;
+        }
+        if (m_dirtyWaterSections & bit) {
+            buildWaterMesh(section);
+            changes |= WATER_CHANGED;
+        }
     }
 
-    m_cubePositions.clear();
-    m_cubePositions.reserve(CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_DEPTH);
-    
-    for (int x = 0; x < CHUNK_WIDTH; x++) {
-        for (int y = 0; y < CHUNK_HEIGHT; y++) {
+    m_dirtySections = 0;
+    m_dirtyWaterSections = 0;
+    return changes;
+}
+
+void Chunk::rebuildCubeMeshes(const Neighbourhood& neighbours, bool bakeAmbientOcclusion) const {
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        buildCubeMesh(section, neighbours, bakeAmbientOcclusion);
+    }
+}
+
+void Chunk::buildCubeMesh(int section, const Neighbourhood& neighbours, bool bakeAmbientOcclusion) const {
+    SectionMesh& mesh = m_sectionMeshes[section];
+    std::int64_t previousBytes = meshBytes(mesh);
+
+    // Pooled chunks keep their capacity, so this only allocates when the section grows
+    mesh.cubes.clear();
+
+    if (m_sectionSolidCounts[section] > 0) {
+        Neighbourhood area = neighbours;
+        area.chunks[1][1] = this;
+
+        // Rows of the section with a one-cube border taken from the sections
+        // above and below and from neighbouring chunks (missing ones read as air)
+        ScratchArena& arena = ScratchArena::forThread();
+        ScratchArena::Scope scope(arena);
+        std::uint64_t* rows = arena.allocate<std::uint64_t>(PADDED_HEIGHT * PADDED_DEPTH);
+        int firstY = section * SECTION_HEIGHT;
+        for (int y = 0; y < PADDED_HEIGHT; y++) {
+            for (int z = 0; z < PADDED_DEPTH; z++) {
+                rows[y * PADDED_DEPTH + z] = paddedRow(area, firstY + y - 1, z - 1);
+            }
+        }
+
+        for (int y = 0; y < SECTION_HEIGHT; y++) {
             for (int z = 0; z < CHUNK_DEPTH; z++) {
-                if (getCube(x, y, z)) {
-                    m_cubePositions.push_back(localToWorld(x, y, z));
+                const std::uint64_t* row = rows + (y + 1) * PADDED_DEPTH + z + 1;
+                std::uint64_t solid = (row[0] >> 1) & ROW_MASK;
+                if (solid == 0) {
+                    continue;
+                }
+
+                // The neighbour in front of each face, with bit x lined up with cube x
+                const std::uint64_t faceNeighbours[6] = {
+                    row[-1] >> 1, row[1] >> 1,
+                    row[0], row[0] >> 2,
+                    row[-PADDED_DEPTH] >> 1, row[PADDED_DEPTH] >> 1
+                };
+
+                // Cubes buried on all six sides are never visible
+                std::uint64_t buried = solid;
+                for (std::uint64_t neighbour : faceNeighbours) {
+                    buried &= neighbour;
+                }
+
+                std::uint64_t exposed = solid & ~buried;
+                while (exposed != 0) {
+                    int x = std::countr_zero(exposed);
+                    exposed &= exposed - 1;
+
+                    std::uint64_t shading = 0;
+                    for (int face = 0; face < 6; face++) {
+                        if ((faceNeighbours[face] >> x) & 1) {
+                            continue;
+                        }
+                        shading |= 1ull << (VISIBLE_SHIFT + face);
+                        if (!bakeAmbientOcclusion) {
+                            shading |= 0xFFull << (face * 8);
+                            continue;
+                        }
+
+                        std::uint16_t occlusion = FACE_OCCLUSION[face][facePlane(rows, x, y, z, face)];
+                        shading |= static_cast<std::uint64_t>(occlusion & 0xFF) << (face * 8);
+                        shading |= static_cast<std::uint64_t>(occlusion >> 8) << (FLIP_SHIFT + face);
+                    }
+
+                    mesh.cubes.push_back({localToWorld(x, firstY + y, z),
+                        glm::uvec2(static_cast<std::uint32_t>(shading), static_cast<std::uint32_t>(shading >> 32))});
                 }
             }
         }
     }
-    
-    m_positionsDirty = false;
-    return m_cubePositions;
+
+    std::int64_t delta = meshBytes(mesh) - previousBytes;
+    if (delta != 0) {
+        MemoryStats::track(MemoryTag::Meshes, delta);
+    }
+}
+
+void Chunk::buildWaterMesh(int section) const {
+    SectionMesh& mesh = m_sectionMeshes[section];
+    std::int64_t previousBytes = meshBytes(mesh);
+    mesh.water.clear();
+
+    if (m_water[section]) {
+        const std::uint8_t* water = m_water[section].get();
+        int firstY = section * SECTION_HEIGHT;
+        for (int y = firstY; y < firstY + SECTION_HEIGHT; y++) {
+            for (int z = 0; z < CHUNK_DEPTH; z++) {
+                for (int x = 0; x < CHUNK_WIDTH; x++) {
+                    std::uint8_t level = water[getSectionIndex(x, y, z)];
+                    if (level > 0 && !getCube(x, y, z)) {
+                        mesh.water.emplace_back(localToWorld(x, y, z), static_cast<float>(level) / MAX_WATER);
+                    }
+                }
+            }
+        }
+    }
+
+    std::int64_t delta = meshBytes(mesh) - previousBytes;
+    if (delta != 0) {
+        MemoryStats::track(MemoryTag::Meshes, delta);
+    }
+}
+
+std::int64_t Chunk::meshBytes(const SectionMesh& mesh) {
+    return static_cast<std::int64_t>(mesh.cubes.capacity() * sizeof(MeshCube) + mesh.water.capacity() * sizeof(glm::vec4));
 }
 
 bool Chunk::getCube(int x, int y, int z) const {
@@ -99,7 +345,15 @@ bool Chunk::getCube(int x, int y, int z) const {
         return false;
     }
     
-    return m_cubes[getIndex(x, y, z)];
+    return (m_cubes[getRowIndex(y, z)] >> x) & 1;
+}
+
+std::uint32_t Chunk::getRow(int y, int z) const {
+    if (y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
+        return 0;
+    }
+
+    return m_cubes[getRowIndex(y, z)];
 }
 
 void Chunk::setCube(int x, int y, int z, bool exists) {
@@ -107,8 +361,61 @@ void Chunk::setCube(int x, int y, int z, bool exists) {
         return;
     }
     
-    m_cubes[getIndex(x, y, z)] = exists;
-    m_positionsDirty = true;
+    std::uint32_t& row = m_cubes[getRowIndex(y, z)];
+    std::uint32_t bit = 1u << x;
+    int section = y / SECTION_HEIGHT;
+    if (((row & bit) != 0) != exists) {
+        m_sectionSolidCounts[section] += exists ? 1 : -1;
+    }
+    row = exists ? (row | bit) : (row & ~bit);
+    markSectionDirty(section);
+
+    // Faces and occlusion of the adjacent section sample across the boundary
+    int layer = y % SECTION_HEIGHT;
+    if (layer == 0 && section > 0) {
+        markCubesDirty(section - 1);
+    } else if (layer == SECTION_HEIGHT - 1 && section < SECTION_COUNT - 1) {
+        markCubesDirty(section + 1);
+    }
+}
+
+std::uint32_t Chunk::writeRow(int y, int z, std::uint32_t mask, std::uint32_t cubes) {
+    std::uint32_t& row = m_cubes[getRowIndex(y, z)];
+    std::uint32_t updated = (row & ~mask) | (cubes & mask);
+    m_sectionSolidCounts[y / SECTION_HEIGHT] += std::popcount(updated) - std::popcount(row);
+    std::uint32_t changed = row ^ updated;
+    row = updated;
+    return changed;
+}
+
+std::uint8_t Chunk::getWater(int x, int y, int z) const {
+    if (!isValidCoordinate(x, y, z)) {
+        return 0;
+    }
+
+    const auto& water = m_water[y / SECTION_HEIGHT];
+    return water ? water[getSectionIndex(x, y, z)] : 0;
+}
+
+void Chunk::setWater(int x, int y, int z, std::uint8_t level) {
+    if (!isValidCoordinate(x, y, z)) {
+        return;
+    }
+
+    int section = y / SECTION_HEIGHT;
+    if (level == 0 && !m_water[section]) {
+        return;
+    }
+    ensureWaterSection(section);
+    m_water[section][getSectionIndex(x, y, z)] = level;
+    markWaterDirty(section);
+}
+
+void Chunk::ensureWaterSection(int section) {
+    if (!m_water[section]) {
+        m_water[section] = std::make_unique<std::uint8_t[]>(SECTION_VOLUME);
+        MemoryStats::track(MemoryTag::Voxels, SECTION_VOLUME);
+    }
 }
 
 glm::vec3 Chunk::localToWorld(int x, int y, int z) const {
@@ -120,12 +427,6 @@ glm::vec3 Chunk::localToWorld(int x, int y, int z) const {
     return glm::vec3(worldX, worldY, worldZ);
 }
 
-int Chunk::getIndex(int x, int y, int z) const {
-    // Convert 3D coordinates to 1D index
-    // Layout: x + z * CHUNK_WIDTH + y * CHUNK_WIDTH * CHUNK_DEPTH
-    return x + z * CHUNK_WIDTH + y * CHUNK_WIDTH * CHUNK_DEPTH;
-}
-
 bool Chunk::isValidCoordinate(int x, int y, int z) const {
     return x >= 0 && x < CHUNK_WIDTH &&
            y >= 0 && y < CHUNK_HEIGHT &&
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <FastNoise/FastNoise.h>
 #include <memory>
+#include <cstdint>
 
 class Chunk
 {
@@ -11,15 +12,83 @@ public:
     static constexpr int CHUNK_WIDTH = 32;
     static constexpr int CHUNK_DEPTH = 32;
     static constexpr int CHUNK_HEIGHT = 256;
+    // Chunks are meshed and simulated in horizontal sections of this height
+    static constexpr int SECTION_HEIGHT = 16;
+    static constexpr int SECTION_COUNT = CHUNK_HEIGHT / SECTION_HEIGHT;
+    static constexpr int SECTION_VOLUME = CHUNK_WIDTH * CHUNK_DEPTH * SECTION_HEIGHT;
+    // Water level of a completely filled cell
+    static constexpr std::uint8_t MAX_WATER = 8;
+
+    // A cube with at least one exposed face. shading packs 2-bit ambient
+    // occlusion per face corner (bit 2 * (face * 4 + corner), 3 = unoccluded),
+    // then per face a diagonal-flip bit (bit 48 + face) and a visibility bit
+    // (bit 54 + face), split into low (x) and high (y) 32-bit words.
+    struct MeshCube {
+        glm::vec3 position;
+        glm::uvec2 shading;
+    };
+
+    // Render data for one section
+    struct SectionMesh {
+        std::vector<MeshCube> cubes;
+        // xyz = world position, w = fill level in (0, 1]
+        std::vector<glm::vec4> water;
+    };
     
+    // Chunks start empty; call generateTerrain() to fill them
     Chunk(int chunkX = 0, int chunkZ = 0);
+    ~Chunk();
+
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+
+    // Re-target a pooled chunk at new coordinates, keeping its buffers
+    void reset(int chunkX, int chunkZ);
     
-    // Generate all cube positions within this chunk
-    std::vector<glm::vec3> generateCubePositions() const;
+    // Flags returned by updateMesh()
+    static constexpr int CUBES_CHANGED = 1;
+    static constexpr int WATER_CHANGED = 2;
+
+    // The 3x3 chunks centred on a chunk, indexed [dx + 1][dz + 1]; null where
+    // not loaded. Meshing samples across borders through these.
+    struct Neighbourhood {
+        const Chunk* chunks[3][3]{};
+    };
+
+    // Rebuild the meshes of sections edited since the last call
+    int updateMesh(const Neighbourhood& neighbours) const;
+    // Rebuild every section's cube mesh now; used to benchmark the mesher
+    void rebuildCubeMeshes(const Neighbourhood& neighbours, bool bakeAmbientOcclusion) const;
+    const SectionMesh& getSectionMesh(int section) const { return m_sectionMeshes[section]; }
+
+    // Flag a section for remeshing on the next updateMesh()
+    void markSectionDirty(int section) { m_dirtySections |= 1u << section; m_dirtyWaterSections |= 1u << section; }
+    void markWaterDirty(int section) { m_dirtyWaterSections |= 1u << section; }
+    // Remesh every section's cubes, e.g. after a neighbouring chunk changed
+    void markCubesDirty() { m_dirtySections = ALL_SECTIONS; }
+    void markCubesDirty(int section) { m_dirtySections |= 1u << section; }
     
-    // Get/Set individual cube at local coordinates (0-15, 0-255, 0-15)
+    // Get/Set individual cube at local coordinates (0-31, 0-255, 0-31)
     bool getCube(int x, int y, int z) const;
     void setCube(int x, int y, int z, bool exists);
+
+    // Solid cubes of one row along x as a bitmask (bit x); 0 outside the chunk
+    std::uint32_t getRow(int y, int z) const;
+    // Overwrite the cubes of a row selected by mask with the matching bits of
+    // cubes and return the bits that changed. For bulk edits: the coordinates
+    // must be valid and nothing is marked dirty; the caller marks each edited
+    // section once.
+    std::uint32_t writeRow(int y, int z, std::uint32_t mask, std::uint32_t cubes);
+
+    // Water level (0 = dry, MAX_WATER = full) at local coordinates
+    std::uint8_t getWater(int x, int y, int z) const;
+    // Sets a level and flags the section's water for remeshing
+    void setWater(int x, int y, int z, std::uint8_t level);
+    // Direct access for the fluid simulation; the section must have been allocated
+    // with ensureWaterSection() and the caller marks dirty sections itself
+    std::uint8_t& waterAt(int x, int y, int z) { return m_water[y / SECTION_HEIGHT][getSectionIndex(x, y, z)]; }
+    void ensureWaterSection(int section);
+    bool hasWaterSection(int section) const { return m_water[section] != nullptr; }
     
     // Get chunk world coordinates
     int getChunkX() const { return m_chunkX; }
@@ -27,10 +96,18 @@ public:
     
     // Convert local coordinates to world coordinates
     glm::vec3 localToWorld(int x, int y, int z) const;
+
+    // Chunk coordinate holding a world x or z. Rounds toward negative infinity,
+    // so columns at negative coordinates land in the chunk that stores them.
+    static int worldToChunkX(int worldX) { return floorDiv(worldX, CHUNK_WIDTH); }
+    static int worldToChunkZ(int worldZ) { return floorDiv(worldZ, CHUNK_DEPTH); }
     
     // Generate terrain using Perlin noise
     void generateTerrain();
     
+    // Terrain surface height at a world column, from the noise heightmap
+    static int getHeightAt(int worldX, int worldZ);
+
     // Static method to initialize noise generator
     static void initializeNoise();
     static void cleanupNoise();
@@ -39,22 +116,38 @@ private:
     // Chunk position in chunk coordinates (not world coordinates)
     int m_chunkX;
     int m_chunkZ;
-    mutable std::vector<glm::vec3> m_cubePositions{};
-    mutable bool m_positionsDirty = false;
+    static constexpr std::uint32_t ALL_SECTIONS = (1u << SECTION_COUNT) - 1;
+    static_assert(CHUNK_WIDTH == 32, "rows are stored as 32-bit masks");
+
+    mutable SectionMesh m_sectionMeshes[SECTION_COUNT]{};
+    mutable std::uint32_t m_dirtySections = 0;
+    mutable std::uint32_t m_dirtyWaterSections = 0;
+    // Number of solid cubes per section, used to size mesh buffers exactly
+    int m_sectionSolidCounts[SECTION_COUNT]{};
+    // Water levels, allocated per section on first use
+    std::unique_ptr<std::uint8_t[]> m_water[SECTION_COUNT];
     
-    // 3D array to store which cubes exist (true = cube exists, false = air)
-    // Using a 1D vector for better memory layout
-    std::vector<bool> m_cubes;
+    // Which cubes exist, one 32-bit mask per row along x (bit set = cube exists).
+    // Rows let the mesher test a whole row of neighbours with a few bit operations.
+    std::vector<std::uint32_t> m_cubes;
     
-    // Helper function to convert 3D coordinates to 1D index
-    int getIndex(int x, int y, int z) const;
+    // Helper function to convert y/z coordinates to a row index
+    int getRowIndex(int y, int z) const { return z + y * CHUNK_DEPTH; }
+    // Index within a section's water array
+    int getSectionIndex(int x, int y, int z) const { return x + z * CHUNK_WIDTH + (y % SECTION_HEIGHT) * CHUNK_WIDTH * CHUNK_DEPTH; }
     
+    static int floorDiv(int value, int divisor) { return (value >= 0 ? value : value - divisor + 1) / divisor; }
+
     // Check if coordinates are valid
     bool isValidCoordinate(int x, int y, int z) const;
     
-    // Get height at a specific x,z coordinate using Perlin noise
-    int getHeightAt(int worldX, int worldZ) const;
-    
+    // Rebuild a single section's cube or water mesh
+    void buildCubeMesh(int section, const Neighbourhood& neighbours, bool bakeAmbientOcclusion) const;
+    void buildWaterMesh(int section) const;
+
+    // Bytes held by a section's mesh buffers
+    static std::int64_t meshBytes(const SectionMesh& mesh);
+
     // Static FastNoise2 generator for all chunks
     static FastNoise::SmartNode<FastNoise::FractalFBm> s_noiseGenerator;
 }; 
\ No newline at end of file
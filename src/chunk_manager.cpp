@@ -1,4 +1,5 @@
 #include "chunk_manager.hpp"
+#include <algorithm>
 
 std::vector<Chunk*> ChunkManager::getChunks() const {
     std::vector<Chunk*> chunkList;
@@ -8,28 +9,70 @@ std::vector<Chunk*> ChunkManager::getChunks() const {
     return chunkList;
 }
 
+std::vector<Chunk*> ChunkManager::getReadyChunks() const {
+    std::vector<Chunk*> chunkList;
+    for (const auto& chunk : chunks) {
+        if (!generationTasks.contains(chunk.first)) {
+            chunkList.push_back(chunk.second.get());
+        }
+    }
+    return chunkList;
+}
+
 bool ChunkManager::updateChunks(int x, int z) {
     bool dirty{false};
     std::unordered_set<std::pair<int, int>, PairHash> desiredChunks = getDesiredChunks(x, z);
 
     std::vector<std::pair<int, int>> newChunks;
-
-    // Create chunks and queue generation tasks
     for (const auto& pos : desiredChunks) {
         if (!chunks.contains(pos)) {
-            chunks[pos] = std::make_unique<Chunk>(pos.first, pos.second);
-            generationTasks[pos] = std::async(std::launch::async, [this, pos]() {
-                chunks[pos]->generateTerrain();
-            });
-            dirty = true;
+            newChunks.push_back(pos);
         }
     }
 
+    // Queue nearest chunks first so the area around the camera fills in before the edges
+    auto distanceSquared = [x, z](const std::pair<int, int>& pos) {
+        int dx = pos.first - x;
+        int dz = pos.second - z;
+        return dx * dx + dz * dz;
+    };
+    std::sort(newChunks.begin(), newChunks.end(), [&](const auto& a, const auto& b) {
+        return distanceSquared(a) < distanceSquared(b);
+    });
+
+    // Create chunks and queue generation tasks
+    for (const auto& pos : newChunks) {
+        std::unique_ptr<Chunk> chunk = chunkPool.acquire();
+        chunk->reset(pos.first, pos.second);
+        Chunk* target = chunk.get();
+        chunks[pos] = std::move(chunk);
+        auto cancelled = std::make_shared<std::atomic<bool>>(false);
+        generationTasks[pos] = {workers.submit([target, cancelled]() {
+            if (cancelled->load()) {
+                return std::vector<ChunkWrites>{};
+            }
+            target->generateTerrain();
+            return StructurePlacer::placeStructures(*target);
+        }), cancelled};
+        dirty = true;
+    }
+
     // Erase obsolete chunks
     for (auto it = chunks.begin(); it != chunks.end();) {
         if (!desiredChunks.contains(it->first)) {
-            generationTasks.erase(it->first);
+            // A worker may still be writing to this chunk; park it until the task is done
+            std::pair<int, int> pos = it->first;
+            auto task = generationTasks.find(pos);
+            if (task != generationTasks.end()) {
+                task->second.cancelled->store(true);
+                retiringChunks.push_back({std::move(it->second), std::move(task->second)});
+                generationTasks.erase(task);
+            } else {
+                chunkPool.release(std::move(it->second));
+            }
+            pendingWrites.removeSource(pos);
             it = chunks.erase(it);
+            markNeighboursDirty(pos.first, pos.second);
             dirty = true;
         } else {
             ++it;
@@ -50,11 +93,31 @@ std::unordered_set<std::pair<int, int>, PairHash> ChunkManager::getDesiredChunks
 }
 
 std::vector<std::pair<int,int>> ChunkManager::pollGeneratedChunks() {
+    reclaimRetiredChunks();
+
     std::vector<std::pair<int,int>> ready;
     for (auto it = generationTasks.begin(); it != generationTasks.end();) {
-        if (it->second.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-            ready.push_back(it->first);
+        if (it->second.result.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            std::pair<int, int> source = it->first;
+            std::vector<ChunkWrites> outgoing = it->second.result.get();
             it = generationTasks.erase(it);
+
+            // Neighbours that are already generated get this chunk's writes now;
+            // the rest pick them up from the queue when they finish
+            std::vector<std::pair<int, int>> targets;
+            for (const auto& batch : outgoing) {
+                targets.push_back(batch.target);
+            }
+            pendingWrites.add(source, std::move(outgoing));
+            for (const auto& target : targets) {
+                if (Chunk* neighbour = getReadyChunk(target.first, target.second)) {
+                    pendingWrites.applyFrom(source, *neighbour);
+                    markNeighboursDirty(target.first, target.second);
+                }
+            }
+            pendingWrites.applyTo(*chunks.at(source));
+            markNeighboursDirty(source.first, source.second);
+            ready.push_back(source);
         } else {
             ++it;
         }
@@ -67,3 +130,59 @@ Chunk* ChunkManager::getChunk(int x, int z) const {
     auto it = chunks.find(key);
     return (it != chunks.end()) ? it->second.get() : nullptr;
 }
+
+bool ChunkManager::isAreaReady(int x, int z, int radius) const {
+    for (int i = x - radius; i <= x + radius; ++i) {
+        for (int j = z - radius; j <= z + radius; ++j) {
+            if (!getReadyChunk(i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+Chunk* ChunkManager::getReadyChunk(int x, int z) const {
+    auto key = std::make_pair(x, z);
+    if (generationTasks.contains(key)) {
+        return nullptr;
+    }
+    return getChunk(x, z);
+}
+
+
+Chunk::Neighbourhood ChunkManager::getNeighbourhood(int x, int z) const {
+    Chunk::Neighbourhood neighbours;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            neighbours.chunks[dx + 1][dz + 1] = getReadyChunk(x + dx, z + dz);
+        }
+    }
+    return neighbours;
+}
+
+void ChunkManager::markNeighboursDirty(int x, int z) {
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            if (dx == 0 && dz == 0) {
+                continue;
+            }
+            if (Chunk* neighbour = getReadyChunk(x + dx, z + dz)) {
+                neighbour->markCubesDirty();
+            }
+        }
+    }
+}
+
+void ChunkManager::reclaimRetiredChunks() {
+    for (auto it = retiringChunks.begin(); it != retiringChunks.end();) {
+        if (it->task.result.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+            // The writes are dropped: the chunk left the window before they were needed
+            it->task.result.get();
+            chunkPool.release(std::move(it->chunk));
+            it = retiringChunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
\ No newline at end of file
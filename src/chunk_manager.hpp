@@ -2,29 +2,67 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <atomic>
 #include <future>
 #include "chunk.hpp"
-
-struct PairHash {
-    size_t operator()(const std::pair<int, int>& p) const {
-        return std::hash<int>()(p.first) ^ (std::hash<int>()(p.second) << 1);
-    }
-};
+#include "pair_hash.hpp"
+#include "structures.hpp"
+#include "object_pool.hpp"
+#include "thread_pool.hpp"
 
 class ChunkManager {
 private:
     std::unordered_map<std::pair<int, int>, std::unique_ptr<Chunk>, PairHash> chunks;
     // pending async generation tasks
-    std::unordered_map<std::pair<int,int>, std::future<void>, PairHash> generationTasks;
+    // each task returns the writes its structures made into neighbouring chunks
+    struct GenerationTask {
+        std::future<std::vector<ChunkWrites>> result;
+        // set when the chunk unloads first, so a task that has not started skips its work
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+    std::unordered_map<std::pair<int,int>, GenerationTask, PairHash> generationTasks;
+    // structure writes waiting for (or kept for) their target chunk
+    PendingWriteQueue pendingWrites;
+    // recycled chunk objects, reused as the window slides
+    ObjectPool<Chunk> chunkPool;
+    // unloaded chunks whose generation task was still queued or running; they
+    // go back to the pool once the task finishes, so unloading never blocks
+    struct RetiringChunk {
+        std::unique_ptr<Chunk> chunk;
+        GenerationTask task;
+    };
+    std::vector<RetiringChunk> retiringChunks;
+    // declared last so workers finish before the chunks they write to are destroyed
+    ThreadPool workers;
+
+    // Remesh the ready chunks around (x, z) after its voxels appeared, changed or went away
+    void markNeighboursDirty(int x, int z);
+    // Return retiring chunks whose tasks have finished to the pool
+    void reclaimRetiredChunks();
 
 public:
     static constexpr int CHUNK_SIZE = 6;
 
     std::vector<Chunk*> getChunks() const;
+    // Chunks whose generation has completed and been polled
+    std::vector<Chunk*> getReadyChunks() const;
     bool updateChunks(int x, int z);
     std::unordered_set<std::pair<int, int>, PairHash> getDesiredChunks(int x, int z) const;
     // Poll and return any chunk positions whose async generation just completed
     std::vector<std::pair<int,int>> pollGeneratedChunks();
     // Access a chunk pointer by its grid coordinates
     Chunk* getChunk(int x, int z) const;
+    // True once every chunk within radius of (x, z) has been generated and polled
+    bool isAreaReady(int x, int z, int radius) const;
+    // True when no generation is outstanding for the current window
+    bool isFullyLoaded() const { return !chunks.empty() && generationTasks.empty(); }
+    // Null if the chunk is missing or still generating
+    Chunk* getReadyChunk(int x, int z) const;
+    // Ready chunks around (x, z), for meshing across chunk borders
+    Chunk::Neighbourhood getNeighbourhood(int x, int z) const;
+    ThreadPool& getWorkers() { return workers; }
+    // Chunk objects parked in the pool / ever allocated
+    size_t pooledChunkCount() const { return chunkPool.idleCount(); }
+    size_t retiringChunkCount() const { return retiringChunks.size(); }
+    size_t allocatedChunkCount() const { return chunkPool.createdCount(); }
 };
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "fluid.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr int SECTION_HEIGHT = Chunk::SECTION_HEIGHT;
+    constexpr int MEMBER_WORDS = Chunk::SECTION_VOLUME / 64;
+
+    // Horizontal face neighbours, in the order water spreads to them
+    constexpr int SIDE_OFFSETS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+    int phaseOf(const SectionKey& key) {
+        return (key.chunkX & 1) | ((key.section & 1) << 1) | ((key.chunkZ & 1) << 2);
+    }
+
+    // A cell addressed relative to a chunk, possibly in one of its horizontal neighbours
+    struct CellRef {
+        Chunk* chunk;
+        int x;
+        int y;
+        int z;
+
+        bool isOpen() const { return chunk && !chunk->getCube(x, y, z); }
+        std::uint8_t& water() const { return chunk->waterAt(x, y, z); }
+        SectionKey key() const { return {chunk->getChunkX(), y / SECTION_HEIGHT, chunk->getChunkZ()}; }
+    };
+}
+
+FluidSimulation::FluidSimulation(ChunkManager& chunkManager) : m_chunkManager(chunkManager) {}
+
+void FluidSimulation::addWater(glm::ivec3 minCorner, glm::ivec3 maxCorner) {
+    for (int y = std::max(minCorner.y, 0); y <= std::min(maxCorner.y, Chunk::CHUNK_HEIGHT - 1); y++) {
+        for (int z = minCorner.z; z <= maxCorner.z; z++) {
+            for (int x = minCorner.x; x <= maxCorner.x; x++) {
+                int chunkX = Chunk::worldToChunkX(x);
+                int chunkZ = Chunk::worldToChunkZ(z);
+                Chunk* chunk = m_chunkManager.getReadyChunk(chunkX, chunkZ);
+                int localX = x - chunkX * Chunk::CHUNK_WIDTH;
+                int localZ = z - chunkZ * Chunk::CHUNK_DEPTH;
+                if (chunk && !chunk->getCube(localX, y, localZ)) {
+                    chunk->setWater(localX, y, localZ, Chunk::MAX_WATER);
+                    activate({x, y, z});
+                }
+            }
+        }
+    }
+}
+
+void FluidSimulation::onChunkReady(int chunkX, int chunkZ) {
+    for (const auto& offset : SIDE_OFFSETS) {
+        Chunk* neighbour = m_chunkManager.getReadyChunk(chunkX + offset[0], chunkZ + offset[1]);
+        if (!neighbour) {
+            continue;
+        }
+
+        // The neighbour's face that touches the new chunk
+        int faceX = offset[0] == 1 ? 0 : Chunk::CHUNK_WIDTH - 1;
+        int faceZ = offset[1] == 1 ? 0 : Chunk::CHUNK_DEPTH - 1;
+        for (int section = 0; section < Chunk::SECTION_COUNT; section++) {
+            if (!neighbour->hasWaterSection(section)) {
+                continue;
+            }
+            for (int y = section * SECTION_HEIGHT; y < (section + 1) * SECTION_HEIGHT; y++) {
+                for (int i = 0; i < (offset[0] != 0 ? Chunk::CHUNK_DEPTH : Chunk::CHUNK_WIDTH); i++) {
+                    int x = offset[0] != 0 ? faceX : i;
+                    int z = offset[0] != 0 ? i : faceZ;
+                    if (neighbour->getWater(x, y, z) > 0) {
+                        activate({neighbour->getChunkX() * Chunk::CHUNK_WIDTH + x, y, neighbour->getChunkZ() * Chunk::CHUNK_DEPTH + z});
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FluidSimulation::wakeRegion(glm::ivec3 minCorner, glm::ivec3 maxCorner) {
+    int minY = std::max(minCorner.y, 0);
+    int maxY = std::min(maxCorner.y, Chunk::CHUNK_HEIGHT - 1);
+    for (int chunkX = Chunk::worldToChunkX(minCorner.x); chunkX <= Chunk::worldToChunkX(maxCorner.x); chunkX++) {
+        for (int chunkZ = Chunk::worldToChunkZ(minCorner.z); chunkZ <= Chunk::worldToChunkZ(maxCorner.z); chunkZ++) {
+            Chunk* chunk = m_chunkManager.getReadyChunk(chunkX, chunkZ);
+            if (!chunk) {
+                continue;
+            }
+
+            // Only sections that hold water can have anything to wake
+            int firstX = std::max(minCorner.x - chunkX * Chunk::CHUNK_WIDTH, 0);
+            int lastX = std::min(maxCorner.x - chunkX * Chunk::CHUNK_WIDTH, Chunk::CHUNK_WIDTH - 1);
+            int firstZ = std::max(minCorner.z - chunkZ * Chunk::CHUNK_DEPTH, 0);
+            int lastZ = std::min(maxCorner.z - chunkZ * Chunk::CHUNK_DEPTH, Chunk::CHUNK_DEPTH - 1);
+            for (int y = minY; y <= maxY; y++) {
+                if (!chunk->hasWaterSection(y / SECTION_HEIGHT)) {
+                    continue;
+                }
+                for (int z = firstZ; z <= lastZ; z++) {
+                    for (int x = firstX; x <= lastX; x++) {
+                        if (chunk->getWater(x, y, z) > 0) {
+                            activate({chunkX * Chunk::CHUNK_WIDTH + x, y, chunkZ * Chunk::CHUNK_DEPTH + z});
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FluidSimulation::activate(glm::ivec3 cell) {
+    if (cell.y < 0 || cell.y >= Chunk::CHUNK_HEIGHT) {
+        return;
+    }
+
+    // Dry cells have nothing to move, so only wet ones are tracked
+    int chunkX = Chunk::worldToChunkX(cell.x);
+    int chunkZ = Chunk::worldToChunkZ(cell.z);
+    int localX = cell.x - chunkX * Chunk::CHUNK_WIDTH;
+    int localZ = cell.z - chunkZ * Chunk::CHUNK_DEPTH;
+    Chunk* chunk = m_chunkManager.getReadyChunk(chunkX, chunkZ);
+    if (!chunk || chunk->getWater(localX, cell.y, localZ) == 0) {
+        return;
+    }
+
+    SectionKey key{chunkX, cell.y / SECTION_HEIGHT, chunkZ};
+    auto [it, inserted] = m_active.try_emplace(key);
+    ActiveSection& active = it->second;
+    if (inserted) {
+        if (!m_spareSections.empty()) {
+            active = std::move(m_spareSections.back());
+            m_spareSections.pop_back();
+        } else {
+            active.members.assign(MEMBER_WORDS, 0);
+        }
+    }
+
+    int index = localX + localZ * Chunk::CHUNK_WIDTH + (cell.y % SECTION_HEIGHT) * Chunk::CHUNK_WIDTH * Chunk::CHUNK_DEPTH;
+    std::uint64_t bit = std::uint64_t(1) << (index & 63);
+    if (!(active.members[index >> 6] & bit)) {
+        active.members[index >> 6] |= bit;
+        active.cells.push_back(static_cast<std::uint16_t>(index));
+        m_activeCellCount++;
+    }
+}
+
+std::uint64_t FluidSimulation::tick() {
+    std::unordered_map<SectionKey, ActiveSection, SectionKeyHash> current;
+    current.swap(m_active);
+    m_activeCellCount = 0;
+
+    // Sort sections into checkerboard phases, dropping any whose chunk unloaded.
+    // Water arrays are allocated here, up front, for every section a job may write to.
+    std::vector<std::pair<const SectionKey*, const ActiveSection*>> phases[8];
+    for (const auto& [key, active] : current) {
+        Chunk* chunk = m_chunkManager.getReadyChunk(key.chunkX, key.chunkZ);
+        if (!chunk) {
+            continue;
+        }
+        chunk->ensureWaterSection(key.section);
+        if (key.section > 0) {
+            chunk->ensureWaterSection(key.section - 1);
+        }
+        if (key.section + 1 < Chunk::SECTION_COUNT) {
+            chunk->ensureWaterSection(key.section + 1);
+        }
+        for (const auto& offset : SIDE_OFFSETS) {
+            if (Chunk* neighbour = m_chunkManager.getReadyChunk(key.chunkX + offset[0], key.chunkZ + offset[1])) {
+                neighbour->ensureWaterSection(key.section);
+            }
+        }
+        phases[phaseOf(key)].emplace_back(&key, &active);
+    }
+
+    std::uint64_t updates = 0;
+    std::vector<JobResult> results;
+    for (const auto& phase : phases) {
+        results.clear();
+        results.resize(phase.size());
+        m_chunkManager.getWorkers().parallelFor(phase.size(), [&](size_t i) {
+            updateSection(*phase[i].first, *phase[i].second, results[i]);
+        });
+
+        // Merge on this thread once the phase's writes are complete
+        for (const auto& result : results) {
+            updates += result.updates;
+            for (const auto& cell : result.woken) {
+                activate(cell);
+            }
+            for (const auto& key : result.touched) {
+                if (Chunk* chunk = m_chunkManager.getReadyChunk(key.chunkX, key.chunkZ)) {
+                    chunk->markWaterDirty(key.section);
+                }
+            }
+        }
+    }
+
+    // Keep the emptied sections' buffers for the next step
+    for (auto& [key, active] : current) {
+        for (std::uint16_t index : active.cells) {
+            active.members[index >> 6] = 0;
+        }
+        active.cells.clear();
+        m_spareSections.push_back(std::move(active));
+    }
+
+    return updates;
+}
+
+void FluidSimulation::updateSection(const SectionKey& key, const ActiveSection& active, JobResult& result) {
+    Chunk* center = m_chunkManager.getReadyChunk(key.chunkX, key.chunkZ);
+    Chunk* east = m_chunkManager.getReadyChunk(key.chunkX + 1, key.chunkZ);
+    Chunk* west = m_chunkManager.getReadyChunk(key.chunkX - 1, key.chunkZ);
+    Chunk* south = m_chunkManager.getReadyChunk(key.chunkX, key.chunkZ + 1);
+    Chunk* north = m_chunkManager.getReadyChunk(key.chunkX, key.chunkZ - 1);
+
+    // Missing neighbours and cells outside the world resolve to a null chunk, i.e. a wall
+    auto resolve = [&](int x, int y, int z) -> CellRef {
+        if (y < 0 || y >= Chunk::CHUNK_HEIGHT) return {nullptr, x, y, z};
+        if (x < 0) return {west, x + Chunk::CHUNK_WIDTH, y, z};
+        if (x >= Chunk::CHUNK_WIDTH) return {east, x - Chunk::CHUNK_WIDTH, y, z};
+        if (z < 0) return {north, x, y, z + Chunk::CHUNK_DEPTH};
+        if (z >= Chunk::CHUNK_DEPTH) return {south, x, y, z - Chunk::CHUNK_DEPTH};
+        return {center, x, y, z};
+    };
+
+    auto touch = [&](const SectionKey& touched) {
+        if (std::find(result.touched.begin(), result.touched.end(), touched) == result.touched.end()) {
+            result.touched.push_back(touched);
+        }
+    };
+
+    int baseX = key.chunkX * Chunk::CHUNK_WIDTH;
+    int baseZ = key.chunkZ * Chunk::CHUNK_DEPTH;
+    int baseY = key.section * SECTION_HEIGHT;
+
+    for (std::uint16_t index : active.cells) {
+        result.updates++;
+        int x = index % Chunk::CHUNK_WIDTH;
+        int z = (index / Chunk::CHUNK_WIDTH) % Chunk::CHUNK_DEPTH;
+        int y = baseY + index / (Chunk::CHUNK_WIDTH * Chunk::CHUNK_DEPTH);
+
+        std::uint8_t& level = center->waterAt(x, y, z);
+        if (level == 0) {
+            continue;
+        }
+        if (center->getCube(x, y, z)) {
+            // Terrain was placed over this water
+            level = 0;
+            touch(key);
+            continue;
+        }
+
+        int remaining = level;
+        bool changed = false;
+
+        // Fall into the cell below first
+        CellRef below = resolve(x, y - 1, z);
+        if (below.isOpen()) {
+            std::uint8_t& belowLevel = below.water();
+            int move = std::min(remaining, Chunk::MAX_WATER - belowLevel);
+            if (move > 0) {
+                belowLevel += move;
+                remaining -= move;
+                changed = true;
+                touch(below.key());
+            }
+        }
+
+        // Then even out with lower horizontal neighbours; a difference of one is stable
+        for (const auto& offset : SIDE_OFFSETS) {
+            if (remaining <= 1) {
+                break;
+            }
+            CellRef side = resolve(x + offset[0], y, z + offset[1]);
+            if (!side.isOpen()) {
+                continue;
+            }
+            std::uint8_t& sideLevel = side.water();
+            int flow = (remaining - sideLevel) / 2;
+            if (flow > 0) {
+                sideLevel += flow;
+                remaining -= flow;
+                changed = true;
+                touch(side.key());
+            }
+        }
+
+        if (changed) {
+            level = static_cast<std::uint8_t>(remaining);
+            touch(key);
+            int worldX = baseX + x;
+            int worldZ = baseZ + z;
+            result.woken.push_back({worldX, y, worldZ});
+            result.woken.push_back({worldX, y - 1, worldZ});
+            result.woken.push_back({worldX, y + 1, worldZ});
+            for (const auto& offset : SIDE_OFFSETS) {
+                result.woken.push_back({worldX + offset[0], y, worldZ + offset[1]});
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "chunk_manager.hpp"
+#include "section_key.hpp"
+
+// Cellular-automaton water over the voxel world. Only cells that changed
+// recently (and their neighbours) are kept in a sparse active set. Sections
+// are updated in parallel in eight checkerboard phases: cells only move
+// water to face neighbours, so two sections of the same colour never write
+// to the same cell.
+class FluidSimulation {
+public:
+    // Fluid steps once every this many simulation ticks
+    static constexpr int TICK_INTERVAL = 4;
+
+    explicit FluidSimulation(ChunkManager& chunkManager);
+
+    // Fill every air cell in the box (world coordinates, inclusive) with water
+    void addWater(glm::ivec3 minCorner, glm::ivec3 maxCorner);
+
+    // Wake water resting against the borders of a chunk that just finished generating
+    void onChunkReady(int chunkX, int chunkZ);
+
+    // Wake water in a box (world coordinates, inclusive) whose cubes were edited
+    void wakeRegion(glm::ivec3 minCorner, glm::ivec3 maxCorner);
+
+    // Advance one step; returns the number of cells updated
+    std::uint64_t tick();
+
+    size_t activeCellCount() const { return m_activeCellCount; }
+
+
+private:
+    struct ActiveSection {
+        std::vector<std::uint16_t> cells;
+        // One bit per cell of the section, so each cell is queued once
+        std::vector<std::uint64_t> members;
+    };
+
+    // Produced by one section job and merged once its phase has finished
+    struct JobResult {
+        std::vector<glm::ivec3> woken;
+        std::vector<SectionKey> touched;
+        std::uint64_t updates = 0;
+    };
+
+    ChunkManager& m_chunkManager;
+    std::unordered_map<SectionKey, ActiveSection, SectionKeyHash> m_active;
+    // Cleared sections kept so their buffers are reused
+    std::vector<ActiveSection> m_spareSections;
+    size_t m_activeCellCount = 0;
+
+    // Queue a wet world cell for the next step (ignored outside ready chunks)
+    void activate(glm::ivec3 cell);
+    void updateSection(const SectionKey& key, const ActiveSection& active, JobResult& result);
+};
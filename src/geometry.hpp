@@ -1,3 +1,6 @@
+#pragma once
+#include <array>
+
 inline constexpr float cubeVertices[] = {
     -0.5f, -0.5f, -0.5f,  0.1f, 0.5f, 0.1f,  // Dark green
     0.5f, -0.5f, -0.5f,   0.2f, 0.7f, 0.2f,  // Medium dark green
@@ -9,17 +12,53 @@ inline constexpr float cubeVertices[] = {
     -0.5f,  0.5f,  0.5f,  0.1f, 0.7f, 0.2f   // Forest green
 };
 
-inline constexpr unsigned int cubeIndices[] = {
-    // Back face (facing -Z)
-    0, 1, 2,    2, 3, 0,
-    // Front face (facing +Z)
-    4, 7, 6,    6, 5, 4,
-    // Left face (facing -X)
-    0, 3, 7,    7, 4, 0,
-    // Right face (facing +X)
-    1, 5, 6,    6, 2, 1,
-    // Bottom face (facing -Y)
-    0, 4, 5,    5, 1, 0,
-    // Top face (facing +Y)
-    3, 2, 6,    6, 7, 3
-};
\ No newline at end of file
+// Corners of each face in winding order. A face is drawn as the triangles
+// (0, 1, 2) (2, 3, 0), or (1, 2, 3) (3, 0, 1) when its diagonal is flipped.
+inline constexpr int cubeFaces[6][4] = {
+    {0, 1, 2, 3},  // Back face (facing -Z)
+    {4, 7, 6, 5},  // Front face (facing +Z)
+    {0, 3, 7, 4},  // Left face (facing -X)
+    {1, 5, 6, 2},  // Right face (facing +X)
+    {0, 4, 5, 1},  // Bottom face (facing -Y)
+    {3, 2, 6, 7}   // Top face (facing +Y)
+};
+
+inline constexpr int cubeFaceNormals[6][3] = {
+    {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}
+};
+
+// One vertex of the unindexed cube. Each carries the corner it uses for both
+// diagonal choices; the vertex shader picks one per face from the instance's
+// flip bits. faceCorner (face * 4 + corner) selects the baked occlusion value.
+struct CubeFaceVertex {
+    float position[3];
+    float color[3];
+    float flippedPosition[3];
+    float flippedColor[3];
+    int faceCorner;
+    int flippedFaceCorner;
+};
+
+inline constexpr int cubeFaceVertexCount = 36;
+
+inline constexpr std::array<CubeFaceVertex, cubeFaceVertexCount> cubeFaceVertices = [] {
+    constexpr int triangles[6] = {0, 1, 2, 2, 3, 0};
+    constexpr int flippedTriangles[6] = {1, 2, 3, 3, 0, 1};
+    std::array<CubeFaceVertex, cubeFaceVertexCount> vertices{};
+    for (int face = 0; face < 6; face++) {
+        for (int i = 0; i < 6; i++) {
+            CubeFaceVertex& vertex = vertices[face * 6 + i];
+            int corner = triangles[i];
+            int flippedCorner = flippedTriangles[i];
+            for (int c = 0; c < 3; c++) {
+                vertex.position[c] = cubeVertices[cubeFaces[face][corner] * 6 + c];
+                vertex.color[c] = cubeVertices[cubeFaces[face][corner] * 6 + 3 + c];
+                vertex.flippedPosition[c] = cubeVertices[cubeFaces[face][flippedCorner] * 6 + c];
+                vertex.flippedColor[c] = cubeVertices[cubeFaces[face][flippedCorner] * 6 + 3 + c];
+            }
+            vertex.faceCorner = face * 4 + corner;
+            vertex.flippedFaceCorner = face * 4 + flippedCorner;
+        }
+    }
+    return vertices;
+}();
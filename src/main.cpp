@@ -5,12 +5,15 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <memory>
+#include <fstream>
+#include <ctime>
+#include <cstddef>
 
 #include "shader.hpp"
 #include "camera.hpp"
 #include "geometry.hpp"
 #include "chunk.hpp"
-#include "chunk_manager.hpp"
+#include "simulation.hpp"
 
 // Force NVIDIA GPU usage on laptops with dual graphics
 extern "C" {
@@ -20,9 +23,11 @@ extern "C" {
 
 constexpr int WIDTH = 1920;
 constexpr int HEIGHT = 1200;
+// Startup timings are appended here on every run
+constexpr const char* STARTUP_METRICS_PATH = "startup_metrics.csv";
 
+// Render-side camera: owns look direction and zoom, position comes from simulation snapshots
 Camera camera{};
-ChunkManager chunkManager{};
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
@@ -51,19 +56,65 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     camera.ProcessMouseScroll(yoffset);
 }
 
-void processInput(GLFWwindow *window, float deltaTime) {
+// True on the frame a key goes down; wasDown remembers the key between frames
+bool keyPressedOnce(GLFWwindow* window, int key, bool& wasDown) {
+    bool down = glfwGetKey(window, key) == GLFW_PRESS;
+    bool pressed = down && !wasDown;
+    wasDown = down;
+    return pressed;
+}
+
+InputCommand processInput(GLFWwindow *window, Simulation& simulation) {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
     }
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        camera.ProcessKeyboard(RIGHT, deltaTime);
+    InputCommand input;
+    input.forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+    input.backward = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+    input.left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+    input.right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+    input.yaw = camera.Yaw;
+    input.pitch = camera.Pitch;
+    input.pourWater = glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS;
+
+    // Print the memory report once per key press
+    static bool reportKeyDown = false;
+    if (keyPressedOnce(window, GLFW_KEY_M, reportKeyDown)) {
+        simulation.requestMemoryReport();
+    }
+
+    // Drop a flood once per key press
+    static bool floodKeyDown = false;
+    if (keyPressedOnce(window, GLFW_KEY_G, floodKeyDown)) {
+        simulation.requestFlood();
+    }
+
+    // Time the chunk mesher once per key press
+    static bool benchmarkKeyDown = false;
+    if (keyPressedOnce(window, GLFW_KEY_K, benchmarkKeyDown)) {
+        simulation.requestMeshingBenchmark();
+    }
+
+    // World edits: carve a sphere, copy or paste a schematic, time a million-voxel fill
+    static bool carveKeyDown = false;
+    static bool copyKeyDown = false;
+    static bool pasteKeyDown = false;
+    static bool fillKeyDown = false;
+    if (keyPressedOnce(window, GLFW_KEY_C, carveKeyDown)) {
+        simulation.requestEdit(EditCommand::CarveSphere);
+    }
+    if (keyPressedOnce(window, GLFW_KEY_X, copyKeyDown)) {
+        simulation.requestEdit(EditCommand::CopySchematic);
+    }
+    if (keyPressedOnce(window, GLFW_KEY_V, pasteKeyDown)) {
+        simulation.requestEdit(EditCommand::PasteSchematic);
+    }
+    if (keyPressedOnce(window, GLFW_KEY_B, fillKeyDown)) {
+        simulation.requestEdit(EditCommand::FillBenchmark);
+    }
+
+    return input;
 }
 
 void setupOpenGL() {
@@ -73,16 +124,13 @@ void setupOpenGL() {
     glFrontFace(GL_CW);
 }
 
-void globalToChunk(int worldX, int worldZ, int& chunkX, int& chunkZ) {
-    chunkX = worldX / Chunk::CHUNK_WIDTH;
-    chunkZ = worldZ / Chunk::CHUNK_DEPTH;
-}
-
 GLFWwindow* initializeWindow() {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Stay hidden until there is something to show
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
     
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Voxel Engine", NULL, NULL);
     if (window == NULL) {
@@ -113,49 +161,58 @@ struct RenderBuffers {
     unsigned int VAO;
     unsigned int VBO;
     unsigned int VBOinstance;
-    unsigned int EBO;
+    // Water shares the cube geometry with its own instance buffer
+    unsigned int waterVAO;
+    unsigned int VBOwater;
 };
 
-RenderBuffers setupRenderBuffers() {
-    RenderBuffers buffers{};
-    
-    glGenVertexArrays(1, &buffers.VAO);
-    glBindVertexArray(buffers.VAO);
+// Creates a VAO drawing the shared cube geometry with per-instance model matrices and shading
+void setupCubeVAO(unsigned int& VAO, unsigned int& VBOinstance, unsigned int VBO) {
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
 
-    glGenBuffers(1, &buffers.VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(CubeFaceVertex), (void*)offsetof(CubeFaceVertex, position));
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(CubeFaceVertex), (void*)offsetof(CubeFaceVertex, color));
     glEnableVertexAttribArray(1);
+    glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(CubeFaceVertex), (void*)offsetof(CubeFaceVertex, flippedPosition));
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(8, 3, GL_FLOAT, GL_FALSE, sizeof(CubeFaceVertex), (void*)offsetof(CubeFaceVertex, flippedColor));
+    glEnableVertexAttribArray(8);
+    glVertexAttribIPointer(9, 2, GL_INT, sizeof(CubeFaceVertex), (void*)offsetof(CubeFaceVertex, faceCorner));
+    glEnableVertexAttribArray(9);
 
-    glGenBuffers(1, &buffers.VBOinstance);
-    glBindBuffer(GL_ARRAY_BUFFER, buffers.VBOinstance);
+    glGenBuffers(1, &VBOinstance);
+    glBindBuffer(GL_ARRAY_BUFFER, VBOinstance);
 
     for (unsigned int i = 0; i < 4; i++) {
-        glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+        glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(offsetof(CubeInstance, model) + i * sizeof(glm::vec4)));
         glEnableVertexAttribArray(2 + i);
         glVertexAttribDivisor(2 + i, 1);
     }
+    glVertexAttribIPointer(6, 2, GL_UNSIGNED_INT, sizeof(CubeInstance), (void*)offsetof(CubeInstance, shading));
+    glEnableVertexAttribArray(6);
+    glVertexAttribDivisor(6, 1);
+}
+
+RenderBuffers setupRenderBuffers() {
+    RenderBuffers buffers{};
 
-    glGenBuffers(1, &buffers.EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
+    glGenBuffers(1, &buffers.VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFaceVertices), cubeFaceVertices.data(), GL_STATIC_DRAW);
+
+    setupCubeVAO(buffers.VAO, buffers.VBOinstance, buffers.VBO);
+    setupCubeVAO(buffers.waterVAO, buffers.VBOwater, buffers.VBO);
     
     return buffers;
 }
 
-std::vector<glm::mat4> generateModelMatrices(const std::vector<Chunk*>& chunks) {
-    std::vector<glm::mat4> modelMatrices;
-    for (const auto& chunk : chunks) {
-        for (auto& cubePosition : chunk->generateCubePositions()) { 
-            glm::mat4 model = glm::mat4(1.0f);
-            modelMatrices.push_back(glm::translate(model, cubePosition));
-        }
-    }
-    return modelMatrices;
+void uploadInstances(unsigned int instanceBuffer, const std::vector<CubeInstance>& instances) {
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CubeInstance), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(CubeInstance), instances.data());
 }
 
 struct FrameTimer {
@@ -164,25 +221,89 @@ struct FrameTimer {
     float fpsUpdateTime = 0.0f;
     int frameCount = 0;
     float fps = 0.0f;
+    float maxFrameTime = 0.0f;
+    // Time from a snapshot being published to the render thread picking it up
+    double handoffTotal = 0.0;
+    double handoffMax = 0.0;
+    int handoffCount = 0;
+
+    void recordHandoff(double latency) {
+        handoffTotal += latency;
+        handoffMax = std::max(handoffMax, latency);
+        handoffCount++;
+    }
     
-    void update() {
+    void update(Simulation& simulation) {
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
         
         frameCount++;
         fpsUpdateTime += deltaTime;
+        maxFrameTime = std::max(maxFrameTime, deltaTime);
         
         if (fpsUpdateTime >= 1.0f) {
             fps = frameCount / fpsUpdateTime;
-            std::cout << "FPS: " << fps << std::endl;
+            TickStats ticks = simulation.takeTickStats();
+            double tickAverage = ticks.ticks > 0 ? ticks.totalSeconds / ticks.ticks : 0.0;
+            double handoffAverage = handoffCount > 0 ? handoffTotal / handoffCount : 0.0;
+            double fluidRate = ticks.fluidSeconds > 0.0 ? ticks.fluidCellUpdates / ticks.fluidSeconds : 0.0;
+            std::cout << "FPS: " << fps
+                      << " | frame " << 1000.0f * fpsUpdateTime / frameCount << " ms (max " << 1000.0f * maxFrameTime << ")"
+                      << " | tick " << 1000.0 * tickAverage << " ms (max " << 1000.0 * ticks.maxSeconds << ", " << ticks.ticks << " ticks)"
+                      << " | handoff " << 1000.0 * handoffAverage << " ms (max " << 1000.0 * handoffMax << ")"
+                      << " | fluid " << ticks.activeFluidCells << " active, " << fluidRate / 1.0e6 << " M cells/s" << std::endl;
             frameCount = 0;
             fpsUpdateTime = 0.0f;
+            maxFrameTime = 0.0f;
+            handoffTotal = 0.0;
+            handoffMax = 0.0;
+            handoffCount = 0;
         }
     }
 };
 
-void render(Shader& shader, const std::vector<glm::mat4>& modelMatrices) {
+// Time from process start to the first presented frame and to the full view being loaded
+struct StartupMetrics {
+    double startTime = Simulation::now();
+    double firstFrame = -1.0;
+    double fullView = -1.0;
+
+    bool hasFirstFrame() const { return firstFrame >= 0.0; }
+    bool hasFullView() const { return fullView >= 0.0; }
+
+    void recordFirstFrame() {
+        firstFrame = Simulation::now() - startTime;
+        std::cout << "Time to first frame: " << 1000.0 * firstFrame << " ms" << std::endl;
+    }
+
+    void recordFullView() {
+        fullView = Simulation::now() - startTime;
+        std::cout << "Time to full view: " << 1000.0 * fullView << " ms" << std::endl;
+
+        std::ifstream existing(STARTUP_METRICS_PATH);
+        bool writeHeader = !existing.good();
+        existing.close();
+
+        std::ofstream out(STARTUP_METRICS_PATH, std::ios::app);
+        if (writeHeader) {
+            out << "timestamp,first_frame_ms,full_view_ms" << std::endl;
+        }
+        out << std::time(nullptr) << "," << 1000.0 * firstFrame << "," << 1000.0 * fullView << std::endl;
+    }
+};
+
+// Position the render camera between the snapshot's last two ticks
+void interpolateCamera(const FrameSnapshot& snapshot) {
+    if (snapshot.tick == 0) {
+        return;
+    }
+    float alpha = static_cast<float>((Simulation::now() - snapshot.tickTime) / Simulation::TICK_DURATION);
+    alpha = std::min(std::max(alpha, 0.0f), 1.0f);
+    camera.Position = glm::mix(snapshot.previousPosition, snapshot.position, alpha);
+}
+
+void render(Shader& shader, const RenderBuffers& buffers, size_t instanceCount, size_t waterCount) {
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -194,10 +315,27 @@ void render(Shader& shader, const std::vector<glm::mat4>& modelMatrices) {
     glm::mat4 view = camera.GetViewMatrix();
     shader.setMat4("view", view);
 
-    glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, modelMatrices.size());
+    shader.setBool("water", false);
+    glBindVertexArray(buffers.VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, cubeFaceVertexCount, instanceCount);
+
+    if (waterCount > 0) {
+        shader.setBool("water", true);
+        glBindVertexArray(buffers.waterVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, cubeFaceVertexCount, waterCount);
+    }
 }
 
 int main() {    
+    StartupMetrics startup;
+
+    // Start generating the spawn area before the window and GL state are set up
+    Chunk::initializeNoise();
+    glm::vec3 spawnPosition(Chunk::CHUNK_WIDTH/2, 80.0f, Chunk::CHUNK_DEPTH/2);
+    camera.Position = spawnPosition;
+    Simulation simulation(spawnPosition);
+    simulation.start();
+
     GLFWwindow* window = initializeWindow();
     if (!window) {
         return -1;
@@ -209,38 +347,60 @@ int main() {
     setupInputCallbacks(window);
     
     FrameTimer timer;
-    Chunk::initializeNoise();
-
-    camera.Position = glm::vec3(Chunk::CHUNK_WIDTH/2, 80.0f, Chunk::CHUNK_DEPTH/2);
 
-    std::vector<glm::mat4> modelMatrices = generateModelMatrices(chunkManager.getChunks());
-    glBindBuffer(GL_ARRAY_BUFFER, buffers.VBOinstance);
-    glBufferData(GL_ARRAY_BUFFER, modelMatrices.size() * sizeof(glm::mat4), modelMatrices.data(), GL_DYNAMIC_DRAW);
+    std::uint64_t uploadedVersion = 0;
+    std::uint64_t uploadedWaterVersion = 0;
+    size_t instanceCount = 0;
+    size_t waterCount = 0;
 
     while(!glfwWindowShouldClose(window)) {
-        timer.update();
-        processInput(window, timer.deltaTime);
-        
-        int chunkX, chunkZ;
-        globalToChunk(camera.Position.x, camera.Position.z, chunkX, chunkZ);
-        chunkManager.updateChunks(chunkX, chunkZ);
-        auto completed = chunkManager.pollGeneratedChunks();
-        
-        if (!completed.empty()) {
-            std::vector<glm::mat4> newMatrices = generateModelMatrices(chunkManager.getChunks());
-            glBindBuffer(GL_ARRAY_BUFFER, buffers.VBOinstance);
-            glBufferData(GL_ARRAY_BUFFER, newMatrices.size() * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, newMatrices.size() * sizeof(glm::mat4), newMatrices.data());
-            modelMatrices.swap(newMatrices);
+        timer.update(simulation);
+        simulation.submitInput(processInput(window, simulation));
+
+        const FrameSnapshot* snapshot = nullptr;
+        if (simulation.acquireSnapshot(snapshot)) {
+            timer.recordHandoff(Simulation::now() - snapshot->publishTime);
+        }
+
+        // Keep the window hidden until the ground under the camera exists
+        if (!startup.hasFirstFrame() && !snapshot->spawnReady) {
+            glfwWaitEventsTimeout(Simulation::TICK_DURATION);
+            continue;
+        }
+
+        // Upload instance data only when the simulation produced a new set
+        if (snapshot->instances && snapshot->instancesVersion != uploadedVersion) {
+            uploadInstances(buffers.VBOinstance, *snapshot->instances);
+            uploadedVersion = snapshot->instancesVersion;
+            instanceCount = snapshot->instances->size();
+        }
+        if (snapshot->waterInstances && snapshot->waterVersion != uploadedWaterVersion) {
+            uploadInstances(buffers.VBOwater, *snapshot->waterInstances);
+            uploadedWaterVersion = snapshot->waterVersion;
+            waterCount = snapshot->waterInstances->size();
         }
 
-        render(ourShader, modelMatrices);
+        interpolateCamera(*snapshot);
+        render(ourShader, buffers, instanceCount, waterCount);
 
+        if (!startup.hasFirstFrame()) {
+            glfwShowWindow(window);
+        }
         glfwSwapBuffers(window);
+        if (!startup.hasFirstFrame()) {
+            startup.recordFirstFrame();
+        }
+        if (!startup.hasFullView() && snapshot->viewComplete) {
+            startup.recordFullView();
+        }
+
         glfwPollEvents();    
     }
 
+    simulation.stop();
+    simulation.printMemoryReport();
+
     Chunk::cleanupNoise();
     glfwTerminate();
     return 0;
-}
\ No newline at end of file
+}
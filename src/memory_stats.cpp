@@ -0,0 +1,98 @@
+#include "memory_stats.hpp"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+std::atomic<std::int64_t> MemoryStats::s_current[MemoryStats::TAG_COUNT]{};
+std::atomic<std::int64_t> MemoryStats::s_peak[MemoryStats::TAG_COUNT]{};
+
+namespace {
+    // Constant-initialised so it is valid before any static constructor runs
+    std::atomic<std::uint64_t> g_allocationCount{0};
+
+    void* countedAlloc(std::size_t size) {
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (void* ptr = std::malloc(size ? size : 1)) {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void MemoryStats::track(MemoryTag tag, std::int64_t bytes) {
+    int index = static_cast<int>(tag);
+    std::int64_t now = s_current[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    std::int64_t previousPeak = s_peak[index].load(std::memory_order_relaxed);
+    while (now > previousPeak && !s_peak[index].compare_exchange_weak(previousPeak, now, std::memory_order_relaxed)) {
+    }
+}
+
+std::int64_t MemoryStats::current(MemoryTag tag) {
+    return s_current[static_cast<int>(tag)].load(std::memory_order_relaxed);
+}
+
+std::int64_t MemoryStats::peak(MemoryTag tag) {
+    return s_peak[static_cast<int>(tag)].load(std::memory_order_relaxed);
+}
+
+std::uint64_t MemoryStats::allocationCount() {
+    return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+std::size_t MemoryStats::peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    // Linux reports kilobytes
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+const char* MemoryStats::tagName(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::Voxels:     return "Voxels";
+        case MemoryTag::Meshes:     return "Meshes";
+        case MemoryTag::Caches:     return "Caches";
+        case MemoryTag::GpuStaging: return "GPU staging";
+        default:                    return "Unknown";
+    }
+}
+
+void MemoryStats::printReport(std::ostream& out) {
+    constexpr double MB = 1024.0 * 1024.0;
+    out << "Memory report:" << std::endl;
+    for (int i = 0; i < TAG_COUNT; ++i) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        out << "  " << tagName(tag) << ": " << current(tag) / MB << " MB (peak " << peak(tag) / MB << " MB)" << std::endl;
+    }
+    out << "  Allocator calls: " << allocationCount() << std::endl;
+    out << "  Peak RSS: " << peakResidentBytes() / MB << " MB" << std::endl;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Subsystems that report their long-lived buffer usage
+enum class MemoryTag {
+    Voxels,
+    Meshes,
+    Caches,
+    GpuStaging,
+    Count
+};
+
+// Process-wide memory accounting. Subsystems report the bytes they hold via
+// track(); allocator calls are counted by the global operator new override.
+class MemoryStats {
+public:
+    // Adjust the bytes held by a subsystem (negative to release)
+    static void track(MemoryTag tag, std::int64_t bytes);
+
+    static std::int64_t current(MemoryTag tag);
+    static std::int64_t peak(MemoryTag tag);
+
+    // Number of calls into operator new since startup
+    static std::uint64_t allocationCount();
+
+    // Peak resident set size of the process in bytes (0 if unavailable)
+    static std::size_t peakResidentBytes();
+
+    static const char* tagName(MemoryTag tag);
+
+    // Print a per-subsystem breakdown along with allocator calls and peak RSS
+    static void printReport(std::ostream& out);
+
+private:
+    static constexpr int TAG_COUNT = static_cast<int>(MemoryTag::Count);
+    static std::atomic<std::int64_t> s_current[TAG_COUNT];
+    static std::atomic<std::int64_t> s_peak[TAG_COUNT];
+};
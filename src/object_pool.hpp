@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <memory>
+
+// Recycles heap objects instead of freeing them. Released objects keep their
+// internal buffers, so reacquiring one avoids fresh allocations; callers are
+// responsible for resetting an acquired object's state.
+template<typename T>
+class ObjectPool {
+public:
+    std::unique_ptr<T> acquire() {
+        if (m_free.empty()) {
+            ++m_created;
+            return std::make_unique<T>();
+        }
+        std::unique_ptr<T> object = std::move(m_free.back());
+        m_free.pop_back();
+        return object;
+    }
+
+    void release(std::unique_ptr<T> object) {
+        if (object) {
+            m_free.push_back(std::move(object));
+        }
+    }
+
+    size_t idleCount() const { return m_free.size(); }
+    size_t createdCount() const { return m_created; }
+
+private:
+    std::vector<std::unique_ptr<T>> m_free;
+    size_t m_created = 0;
+};
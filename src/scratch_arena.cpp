@@ -0,0 +1,40 @@
+#include "scratch_arena.hpp"
+#include "memory_stats.hpp"
+
+ScratchArena::~ScratchArena() {
+    for (const auto& block : m_blocks) {
+        MemoryStats::track(MemoryTag::Caches, -static_cast<std::int64_t>(block.size));
+    }
+}
+
+ScratchArena& ScratchArena::forThread() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void ScratchArena::rewind(Mark mark) {
+    m_current = mark.block;
+    m_offset = mark.offset;
+}
+
+void* ScratchArena::allocateBytes(size_t bytes, size_t alignment) {
+    // Try the current block, then any later (already allocated) blocks
+    while (m_current < m_blocks.size()) {
+        Block& block = m_blocks[m_current];
+        size_t aligned = (m_offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= block.size) {
+            m_offset = aligned + bytes;
+            return block.data.get() + aligned;
+        }
+        ++m_current;
+        m_offset = 0;
+    }
+
+    // Out of space: grow by a new block large enough for this request
+    size_t size = std::max(BLOCK_SIZE, bytes + alignment);
+    m_blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    MemoryStats::track(MemoryTag::Caches, static_cast<std::int64_t>(size));
+    m_current = m_blocks.size() - 1;
+    m_offset = 0;
+    return allocateBytes(bytes, alignment);
+}
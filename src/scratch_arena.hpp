@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+// Per-thread bump allocator for transient generation and meshing data.
+// Allocations are released together by rewinding to a mark, usually via Scope.
+class ScratchArena {
+public:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    // Restores the arena to its state at construction when it goes out of scope
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena) : m_arena(arena), m_mark(arena.mark()) {}
+        ~Scope() { m_arena.rewind(m_mark); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        ScratchArena& m_arena;
+        Mark m_mark;
+    };
+
+    ScratchArena() = default;
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // The calling thread's arena
+    static ScratchArena& forThread();
+
+    // Uninitialised storage for count objects of a trivially destructible type
+    template<typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destructed");
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    Mark mark() const { return {m_current, m_offset}; }
+    void rewind(Mark mark);
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_current = 0;
+    size_t m_offset = 0;
+
+    void* allocateBytes(size_t bytes, size_t alignment);
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <functional>
+
+// Identifies one section of one chunk
+struct SectionKey {
+    int chunkX;
+    int section;
+    int chunkZ;
+
+    bool operator==(const SectionKey& other) const {
+        return chunkX == other.chunkX && section == other.section && chunkZ == other.chunkZ;
+    }
+};
+
+struct SectionKeyHash {
+    size_t operator()(const SectionKey& key) const {
+        return std::hash<int>()(key.chunkX) ^ (std::hash<int>()(key.chunkZ) << 1) ^ (std::hash<int>()(key.section) << 2);
+    }
+};
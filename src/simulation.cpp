@@ -0,0 +1,410 @@
+#include "simulation.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "memory_stats.hpp"
+
+namespace {
+    // Give up on catching up after this many missed ticks rather than spiralling
+    constexpr int MAX_CATCH_UP_TICKS = 5;
+    // Share of each startup tick this thread spends running generation tasks
+    constexpr double STARTUP_HELP_FRACTION = 0.75;
+    // How far ahead of the camera water is poured, and the size of a flood
+    constexpr float POUR_DISTANCE = 6.0f;
+    constexpr int POUR_RADIUS = 1;
+    constexpr int FLOOD_RADIUS = 32;
+    constexpr int FLOOD_DEPTH = 8;
+    // Meshing benchmark passes per mode (the fastest is kept) and the share of
+    // plain meshing time that baking ambient occlusion is allowed to add
+    constexpr int MESH_BENCHMARK_ROUNDS = 31;
+    constexpr double AO_OVERHEAD_BUDGET = 0.35;
+    // World edits: how far ahead of the camera they land, their sizes and
+    // where copied schematics are kept
+    constexpr float EDIT_DISTANCE = 12.0f;
+    constexpr int CARVE_RADIUS = 6;
+    constexpr int COPY_RADIUS = 8;
+    const char* const SCHEMATIC_PATH = "schematic.vxs";
+    // 128 x 64 x 128 = 1,048,576 voxels
+    const glm::ivec3 BENCHMARK_FILL_SIZE(128, 64, 128);
+
+    // Water is drawn with every face visible and unoccluded
+    const glm::uvec2 UNSHADED_CUBE(0xFFFFFFFFu, 0xFFFFu | (0x3Fu << 22));
+
+    void globalToChunk(float worldX, float worldZ, int& chunkX, int& chunkZ) {
+        chunkX = Chunk::worldToChunkX(static_cast<int>(std::floor(worldX)));
+        chunkZ = Chunk::worldToChunkZ(static_cast<int>(std::floor(worldZ)));
+    }
+}
+
+Simulation::Simulation(glm::vec3 spawnPosition)
+    : m_fluid(m_chunkManager), m_worldEdit(m_chunkManager), m_camera(spawnPosition), m_previousPosition(spawnPosition) {}
+
+Simulation::~Simulation() {
+    stop();
+}
+
+void Simulation::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread([this]() { run(); });
+}
+
+void Simulation::stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void Simulation::submitInput(const InputCommand& input) {
+    std::lock_guard<std::mutex> lock(m_inputMutex);
+    m_input = input;
+}
+
+void Simulation::requestEdit(EditCommand command) {
+    std::lock_guard<std::mutex> lock(m_inputMutex);
+    m_editRequests.push_back(command);
+}
+
+bool Simulation::acquireSnapshot(const FrameSnapshot*& snapshot) {
+    bool fresh = m_snapshots.update();
+    snapshot = &m_snapshots.readBuffer();
+    return fresh;
+}
+
+TickStats Simulation::takeTickStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    TickStats stats = m_stats;
+    m_stats = {};
+    return stats;
+}
+
+void Simulation::printMemoryReport() const {
+    MemoryStats::printReport(std::cout);
+    std::cout << "  Chunk pool: " << m_chunkManager.allocatedChunkCount() << " allocated, "
+              << m_chunkManager.pooledChunkCount() << " idle, "
+              << m_chunkManager.retiringChunkCount() << " retiring" << std::endl;
+}
+
+double Simulation::now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Simulation::run() {
+    double nextTick = now();
+    while (m_running) {
+        double tickStart = now();
+        tick(nextTick);
+        double tickSeconds = now() - tickStart;
+
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.ticks++;
+            m_stats.totalSeconds += tickSeconds;
+            m_stats.maxSeconds = std::max(m_stats.maxSeconds, tickSeconds);
+        }
+
+        nextTick += TICK_DURATION;
+        double current = now();
+        if (current - nextTick > MAX_CATCH_UP_TICKS * TICK_DURATION) {
+            nextTick = current;
+        }
+        if (nextTick > current) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(nextTick - current));
+        }
+    }
+}
+
+void Simulation::tick(double tickTime) {
+    InputCommand input;
+    std::vector<EditCommand> edits;
+    {
+        std::lock_guard<std::mutex> lock(m_inputMutex);
+        input = m_input;
+        edits.swap(m_editRequests);
+    }
+
+    // Movement always advances by one fixed step, independent of frame rate
+    m_previousPosition = m_camera.Position;
+    m_camera.SetOrientation(input.yaw, input.pitch);
+    float step = static_cast<float>(TICK_DURATION);
+    if (input.forward)
+        m_camera.ProcessKeyboard(FORWARD, step);
+    if (input.backward)
+        m_camera.ProcessKeyboard(BACKWARD, step);
+    if (input.left)
+        m_camera.ProcessKeyboard(LEFT, step);
+    if (input.right)
+        m_camera.ProcessKeyboard(RIGHT, step);
+
+    int chunkX, chunkZ;
+    globalToChunk(m_camera.Position.x, m_camera.Position.z, chunkX, chunkZ);
+    m_chunkManager.updateChunks(chunkX, chunkZ);
+    std::vector<std::pair<int, int>> completed = m_chunkManager.pollGeneratedChunks();
+
+    // At startup nothing else needs this thread, so it joins the workers. Once
+    // the spawn area first completes it stops early so that frame goes out now.
+    if (!m_startupComplete) {
+        double helpUntil = now() + TICK_DURATION * STARTUP_HELP_FRACTION;
+        while (now() < helpUntil && (m_spawnReady || !m_chunkManager.isAreaReady(chunkX, chunkZ, SPAWN_RADIUS))
+               && m_chunkManager.getWorkers().tryRunPendingTask()) {
+            auto more = m_chunkManager.pollGeneratedChunks();
+            completed.insert(completed.end(), more.begin(), more.end());
+        }
+    }
+
+    for (const auto& pos : completed) {
+        m_fluid.onChunkReady(pos.first, pos.second);
+    }
+
+    for (EditCommand command : edits) {
+        runEdit(command);
+    }
+
+    if (m_tick % FluidSimulation::TICK_INTERVAL == 0) {
+        stepFluid(input);
+    }
+
+    // Only sections touched since the last tick are remeshed; chunks still
+    // being generated are skipped until their task completes
+    std::vector<Chunk*> chunks = m_chunkManager.getReadyChunks();
+    int changes = 0;
+    for (const auto& chunk : chunks) {
+        changes |= chunk->updateMesh(m_chunkManager.getNeighbourhood(chunk->getChunkX(), chunk->getChunkZ()));
+    }
+    // Loading or unloading a chunk changes the set even if no mesh did
+    if (chunks.size() != m_lastReadyCount) {
+        changes |= Chunk::CUBES_CHANGED | Chunk::WATER_CHANGED;
+        m_lastReadyCount = chunks.size();
+    }
+    if (changes & Chunk::CUBES_CHANGED) {
+        rebuildInstances(chunks);
+    }
+    if (changes & Chunk::WATER_CHANGED) {
+        rebuildWaterInstances(chunks);
+    }
+
+    m_spawnReady = m_chunkManager.isAreaReady(chunkX, chunkZ, SPAWN_RADIUS);
+    m_viewComplete = m_chunkManager.isFullyLoaded();
+    if (m_viewComplete) {
+        m_startupComplete = true;
+    }
+
+    if (m_reportRequested.exchange(false)) {
+        printMemoryReport();
+    }
+    if (m_benchmarkRequested.exchange(false)) {
+        runMeshingBenchmark(chunks);
+    }
+
+    publishSnapshot(tickTime);
+}
+
+void Simulation::stepFluid(const InputCommand& input) {
+    glm::vec3 position = m_camera.Position;
+    if (input.pourWater) {
+        glm::ivec3 target(glm::floor(position + m_camera.Front * POUR_DISTANCE));
+        glm::ivec3 extent(POUR_RADIUS, 0, POUR_RADIUS);
+        m_fluid.addWater(target - extent, target + extent);
+    }
+    if (m_floodRequested.exchange(false)) {
+        glm::ivec3 center(glm::floor(position));
+        m_fluid.addWater(center - glm::ivec3(FLOOD_RADIUS, FLOOD_DEPTH, FLOOD_RADIUS),
+                         center + glm::ivec3(FLOOD_RADIUS, -1, FLOOD_RADIUS));
+    }
+
+    double start = now();
+    std::uint64_t updates = m_fluid.tick();
+    double seconds = now() - start;
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.fluidSteps++;
+    m_stats.fluidCellUpdates += updates;
+    m_stats.fluidSeconds += seconds;
+    m_stats.activeFluidCells = m_fluid.activeCellCount();
+}
+
+void Simulation::runEdit(EditCommand command) {
+    glm::ivec3 target(glm::floor(m_camera.Position + m_camera.Front * EDIT_DISTANCE));
+    double start = now();
+    switch (command) {
+    case EditCommand::CarveSphere:
+        m_worldEdit.fillSphere(target, CARVE_RADIUS, false);
+        commitEdit("Carve", start);
+        break;
+    case EditCommand::CopySchematic: {
+        glm::ivec3 extent(COPY_RADIUS, COPY_RADIUS, COPY_RADIUS);
+        Schematic schematic = m_worldEdit.copy(target - extent, target + extent);
+        if (schematic.save(SCHEMATIC_PATH)) {
+            std::cout << "Copied " << schematic.solidCount() << " voxels to " << SCHEMATIC_PATH << std::endl;
+        } else {
+            std::cout << "Failed to write " << SCHEMATIC_PATH << std::endl;
+        }
+        break;
+    }
+    case EditCommand::PasteSchematic: {
+        std::optional<Schematic> schematic = Schematic::load(SCHEMATIC_PATH);
+        if (!schematic) {
+            std::cout << "No schematic to paste in " << SCHEMATIC_PATH << std::endl;
+            break;
+        }
+        glm::ivec3 size = schematic->size();
+        m_worldEdit.paste(*schematic, target - glm::ivec3(size.x / 2, size.y / 2, size.z / 2));
+        commitEdit("Paste", start);
+        break;
+    }
+    case EditCommand::FillBenchmark: {
+        // Above the camera, kept inside the world's height
+        glm::ivec3 position(glm::floor(m_camera.Position));
+        glm::ivec3 minCorner(position.x - BENCHMARK_FILL_SIZE.x / 2,
+                             std::min(position.y + 8, Chunk::CHUNK_HEIGHT - BENCHMARK_FILL_SIZE.y),
+                             position.z - BENCHMARK_FILL_SIZE.z / 2);
+        glm::ivec3 maxCorner = minCorner + BENCHMARK_FILL_SIZE - glm::ivec3(1, 1, 1);
+        // Keep what was there so the benchmark leaves the world as it found it
+        Schematic saved = m_worldEdit.copy(minCorner, maxCorner);
+        start = now();
+        m_worldEdit.fillBox(minCorner, maxCorner, true);
+        commitEdit("Fill", start);
+        start = now();
+        m_worldEdit.fillBox(minCorner, maxCorner, false);
+        commitEdit("Clear", start);
+
+        // Untimed; fluid has not stepped since the fill, so no water was lost to it
+        m_worldEdit.fillBox(minCorner, maxCorner, false);
+        m_worldEdit.paste(saved, minCorner);
+        commitEdit("Restore", now());
+        break;
+    }
+    }
+}
+
+void Simulation::commitEdit(const char* label, double startTime) {
+    EditStats stats = m_worldEdit.commit();
+    double seconds = now() - startTime;
+    if (stats.voxelsChanged > 0) {
+        // Water next to carved-out space should start flowing into it
+        glm::ivec3 margin(1, 1, 1);
+        m_fluid.wakeRegion(stats.minCorner - margin, stats.maxCorner + margin);
+    }
+
+    double rate = seconds > 0.0 ? stats.voxelsWritten / seconds : 0.0;
+    std::cout << label << ": " << stats.voxelsWritten << " voxels written (" << stats.voxelsChanged << " changed) in "
+              << seconds * 1000.0 << " ms (commit " << stats.seconds * 1000.0 << " ms), " << rate / 1e6
+              << " M voxels/s; " << stats.sectionsEdited
+              << " sections edited, " << stats.sectionsRemeshed << " queued for remeshing" << std::endl;
+}
+
+void Simulation::runMeshingBenchmark(const std::vector<Chunk*>& chunks) {
+    std::vector<Chunk::Neighbourhood> neighbourhoods;
+    for (const auto& chunk : chunks) {
+        neighbourhoods.push_back(m_chunkManager.getNeighbourhood(chunk->getChunkX(), chunk->getChunkZ()));
+    }
+    auto timeMeshing = [&](bool bakeAmbientOcclusion) {
+        double best = 0.0;
+        for (int round = 0; round < MESH_BENCHMARK_ROUNDS; round++) {
+            double start = now();
+            for (size_t i = 0; i < chunks.size(); i++) {
+                chunks[i]->rebuildCubeMeshes(neighbourhoods[i], bakeAmbientOcclusion);
+            }
+            double seconds = now() - start;
+            best = round == 0 ? seconds : std::min(best, seconds);
+        }
+        return best;
+    };
+
+    // The occluded pass runs last so the meshes are left as normal
+    double plain = timeMeshing(false);
+    double occluded = timeMeshing(true);
+    double overhead = plain > 0.0 ? occluded / plain - 1.0 : 0.0;
+    std::cout << "Meshing " << chunks.size() << " chunks: " << plain * 1000.0 << " ms plain, "
+              << occluded * 1000.0 << " ms with ambient occlusion (+" << overhead * 100.0 << "%, budget "
+              << AO_OVERHEAD_BUDGET * 100.0 << "%" << (overhead <= AO_OVERHEAD_BUDGET ? ")" : ", over budget)")
+              << std::endl;
+}
+
+std::vector<CubeInstance>& Simulation::InstanceStream::begin() {
+    m_pending.reset();
+    for (auto& candidate : buffers) {
+        if (candidate.use_count() == 1) {
+            m_pending = candidate;
+            break;
+        }
+    }
+    if (!m_pending) {
+        m_pending = buffers.emplace_back(std::make_shared<std::vector<CubeInstance>>());
+    }
+    m_pending->clear();
+    return *m_pending;
+}
+
+void Simulation::InstanceStream::commit(size_t previousCapacity) {
+    std::int64_t grownBytes = (static_cast<std::int64_t>(m_pending->capacity()) - static_cast<std::int64_t>(previousCapacity)) * sizeof(CubeInstance);
+    if (grownBytes != 0) {
+        MemoryStats::track(MemoryTag::GpuStaging, grownBytes);
+    }
+    current = std::move(m_pending);
+    version++;
+}
+
+void Simulation::rebuildInstances(const std::vector<Chunk*>& chunks) {
+    std::vector<CubeInstance>& buffer = m_instances.begin();
+    size_t previousCapacity = buffer.capacity();
+
+    size_t cubeCount = 0;
+    for (const auto& chunk : chunks) {
+        for (int section = 0; section < Chunk::SECTION_COUNT; section++) {
+            cubeCount += chunk->getSectionMesh(section).cubes.size();
+        }
+    }
+
+    buffer.reserve(cubeCount);
+    for (const auto& chunk : chunks) {
+        for (int section = 0; section < Chunk::SECTION_COUNT; section++) {
+            for (const auto& cube : chunk->getSectionMesh(section).cubes) {
+                glm::mat4 model = glm::mat4(1.0f);
+                buffer.push_back({glm::translate(model, cube.position), cube.shading});
+            }
+        }
+    }
+
+    m_instances.commit(previousCapacity);
+}
+
+void Simulation::rebuildWaterInstances(const std::vector<Chunk*>& chunks) {
+    std::vector<CubeInstance>& buffer = m_waterInstances.begin();
+    size_t previousCapacity = buffer.capacity();
+
+    for (const auto& chunk : chunks) {
+        for (int section = 0; section < Chunk::SECTION_COUNT; section++) {
+            for (const auto& cell : chunk->getSectionMesh(section).water) {
+                // Partially filled cells are squashed down onto the cell floor
+                float level = cell.w;
+                glm::vec3 center(cell.x, cell.y - 0.5f + 0.5f * level, cell.z);
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), center);
+                buffer.push_back({glm::scale(model, glm::vec3(1.0f, level, 1.0f)), UNSHADED_CUBE});
+            }
+        }
+    }
+
+    m_waterInstances.commit(previousCapacity);
+}
+
+void Simulation::publishSnapshot(double tickTime) {
+    FrameSnapshot& snapshot = m_snapshots.writeBuffer();
+    snapshot.tick = ++m_tick;
+    snapshot.tickTime = tickTime;
+    snapshot.previousPosition = m_previousPosition;
+    snapshot.position = m_camera.Position;
+    snapshot.instances = m_instances.current;
+    snapshot.instancesVersion = m_instances.version;
+    snapshot.waterInstances = m_waterInstances.current;
+    snapshot.waterVersion = m_waterInstances.version;
+    snapshot.spawnReady = m_spawnReady;
+    snapshot.viewComplete = m_viewComplete;
+    snapshot.publishTime = now();
+    m_snapshots.publish();
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "camera.hpp"
+#include "chunk_manager.hpp"
+#include "fluid.hpp"
+#include "triple_buffer.hpp"
+#include "world_edit.hpp"
+
+// Input sampled by the render thread and consumed once per simulation tick
+struct InputCommand {
+    bool forward = false;
+    bool backward = false;
+    bool left = false;
+    bool right = false;
+    // Look direction is applied on the render thread and mirrored here for movement
+    float yaw = YAW;
+    float pitch = PITCH;
+    // Pour water where the camera is looking
+    bool pourWater = false;
+};
+
+// World edits the render thread can ask for, aimed where the camera looks
+enum class EditCommand {
+    CarveSphere,
+    CopySchematic,
+    PasteSchematic,
+    // Fill and then clear a million-voxel box, reporting the write rate
+    FillBenchmark
+};
+
+// Per-instance vertex data: placement plus the Chunk::MeshCube shading bits
+struct CubeInstance {
+    glm::mat4 model;
+    glm::uvec2 shading;
+};
+
+// Immutable view of the world handed from the simulation to the render thread
+struct FrameSnapshot {
+    std::uint64_t tick = 0;
+    // Scheduled time of this tick and the moment it was handed off (seconds, steady clock)
+    double tickTime = 0.0;
+    double publishTime = 0.0;
+    // Camera position at the previous and the current tick, for interpolation
+    glm::vec3 previousPosition{};
+    glm::vec3 position{};
+    // Instance data is shared between snapshots until the world changes
+    std::shared_ptr<const std::vector<CubeInstance>> instances;
+    std::uint64_t instancesVersion = 0;
+    std::shared_ptr<const std::vector<CubeInstance>> waterInstances;
+    std::uint64_t waterVersion = 0;
+    // The chunks around the camera are generated and included in the instances
+    bool spawnReady = false;
+    // Every chunk in the view window is generated and included
+    bool viewComplete = false;
+};
+
+// Simulation timing accumulated since the last call to takeTickStats()
+struct TickStats {
+    int ticks = 0;
+    double totalSeconds = 0.0;
+    double maxSeconds = 0.0;
+    // Fluid steps, cells they updated and time spent in them
+    int fluidSteps = 0;
+    std::uint64_t fluidCellUpdates = 0;
+    double fluidSeconds = 0.0;
+    size_t activeFluidCells = 0;
+};
+
+// Runs world updates on a dedicated thread at a fixed tick rate. The
+// simulation owns the ChunkManager and the camera's logical position; the
+// render thread only ever sees published FrameSnapshots.
+class Simulation {
+public:
+    static constexpr double TICK_RATE = 60.0;
+    static constexpr double TICK_DURATION = 1.0 / TICK_RATE;
+    // Chunks within this many chunks of the camera must be ready before the first frame
+    static constexpr int SPAWN_RADIUS = 1;
+
+    explicit Simulation(glm::vec3 spawnPosition);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void start();
+    void stop();
+
+    // Render thread: replace the input applied from the next tick onwards
+    void submitInput(const InputCommand& input);
+
+    // Render thread: fetch the newest snapshot. Returns true if it is new;
+    // the reference stays valid until the next call.
+    bool acquireSnapshot(const FrameSnapshot*& snapshot);
+
+    TickStats takeTickStats();
+
+    // Ask the simulation thread to print the memory report on its next tick
+    void requestMemoryReport() { m_reportRequested = true; }
+    // Ask the simulation thread to drop a large body of water above the camera
+    void requestFlood() { m_floodRequested = true; }
+    // Ask the simulation thread to time meshing with and without ambient occlusion
+    void requestMeshingBenchmark() { m_benchmarkRequested = true; }
+    // Queue a world edit for the next tick
+    void requestEdit(EditCommand command);
+    // Only safe while the simulation thread is stopped
+    void printMemoryReport() const;
+
+    // Monotonic seconds shared by both threads
+    static double now();
+
+private:
+    // Instance data shared with snapshots. Buffers are recycled once no
+    // snapshot refers to them any more, so staging capacity carries over.
+    struct InstanceStream {
+        std::vector<std::shared_ptr<std::vector<CubeInstance>>> buffers;
+        std::shared_ptr<const std::vector<CubeInstance>> current;
+        std::uint64_t version = 0;
+
+        // A cleared buffer to fill; becomes current after commit()
+        std::vector<CubeInstance>& begin();
+        void commit(size_t previousCapacity);
+
+    private:
+        std::shared_ptr<std::vector<CubeInstance>> m_pending;
+    };
+
+    ChunkManager m_chunkManager;
+    FluidSimulation m_fluid;
+    WorldEdit m_worldEdit;
+    Camera m_camera;
+    glm::vec3 m_previousPosition;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_reportRequested{false};
+    std::atomic<bool> m_floodRequested{false};
+    std::atomic<bool> m_benchmarkRequested{false};
+
+    std::mutex m_inputMutex;
+    InputCommand m_input;
+    std::vector<EditCommand> m_editRequests;
+
+    std::mutex m_statsMutex;
+    TickStats m_stats;
+
+    TripleBuffer<FrameSnapshot> m_snapshots;
+    std::uint64_t m_tick = 0;
+    size_t m_lastReadyCount = 0;
+    // Set once the first full view has loaded; until then this thread helps generate chunks
+    bool m_startupComplete = false;
+    bool m_spawnReady = false;
+    bool m_viewComplete = false;
+
+    InstanceStream m_instances;
+    InstanceStream m_waterInstances;
+
+    void run();
+    void tick(double tickTime);
+    void stepFluid(const InputCommand& input);
+    void runEdit(EditCommand command);
+    // Apply the edits recorded since startTime, wake water around them and print the stats
+    void commitEdit(const char* label, double startTime);
+    void runMeshingBenchmark(const std::vector<Chunk*>& chunks);
+    void rebuildInstances(const std::vector<Chunk*>& chunks);
+    void rebuildWaterInstances(const std::vector<Chunk*>& chunks);
+    void publishSnapshot(double tickTime);
+};
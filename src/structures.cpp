@@ -0,0 +1,177 @@
+#include "structures.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    constexpr int MAX_FEATURES_PER_CHUNK = 3;
+
+    // splitmix64: cheap, well mixed, and identical on every platform
+    std::uint64_t nextRandom(std::uint64_t& state) {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    int randomRange(std::uint64_t& state, int count) {
+        return static_cast<int>(nextRandom(state) % static_cast<std::uint64_t>(count));
+    }
+}
+
+// Routes world-space writes either straight into the chunk being generated
+// or into per-neighbour batches. Only ever touched by one worker.
+class StructurePlacer::Writer {
+public:
+    explicit Writer(Chunk& chunk) : m_chunk(chunk) {}
+
+    void setSolid(int worldX, int y, int worldZ) {
+        if (y < 0 || y >= Chunk::CHUNK_HEIGHT) {
+            return;
+        }
+
+        int chunkX = Chunk::worldToChunkX(worldX);
+        int chunkZ = Chunk::worldToChunkZ(worldZ);
+        int localX = worldX - chunkX * Chunk::CHUNK_WIDTH;
+        int localZ = worldZ - chunkZ * Chunk::CHUNK_DEPTH;
+        if (chunkX == m_chunk.getChunkX() && chunkZ == m_chunk.getChunkZ()) {
+            m_chunk.setCube(localX, y, localZ, true);
+            return;
+        }
+
+        VoxelWrite write{static_cast<std::uint8_t>(localX), static_cast<std::uint8_t>(localZ), static_cast<std::uint16_t>(y)};
+        std::pair<int, int> target(chunkX, chunkZ);
+        for (auto& batch : m_outgoing) {
+            if (batch.target == target) {
+                batch.writes.push_back(write);
+                return;
+            }
+        }
+        m_outgoing.push_back({target, {write}});
+    }
+
+    std::vector<ChunkWrites> takeOutgoing() { return std::move(m_outgoing); }
+
+private:
+    Chunk& m_chunk;
+    std::vector<ChunkWrites> m_outgoing;
+};
+
+std::vector<ChunkWrites> StructurePlacer::placeStructures(Chunk& chunk) {
+    Writer writer(chunk);
+
+    // Seed from the chunk coordinates alone so placement never depends on generation order
+    std::uint64_t rng = WORLD_SEED
+        ^ (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunk.getChunkX())) << 32)
+        ^ static_cast<std::uint32_t>(chunk.getChunkZ());
+    nextRandom(rng);
+
+    int featureCount = randomRange(rng, MAX_FEATURES_PER_CHUNK + 1);
+    for (int i = 0; i < featureCount; i++) {
+        int worldX = chunk.getChunkX() * Chunk::CHUNK_WIDTH + randomRange(rng, Chunk::CHUNK_WIDTH);
+        int worldZ = chunk.getChunkZ() * Chunk::CHUNK_DEPTH + randomRange(rng, Chunk::CHUNK_DEPTH);
+        bool isTree = randomRange(rng, 4) != 0;
+
+        // Read the ground from the heightmap rather than the voxels, which
+        // may already contain writes from neighbouring features
+        int groundY = std::clamp(Chunk::getHeightAt(worldX, worldZ), 0, Chunk::CHUNK_HEIGHT - 1);
+
+        if (isTree) {
+            placeTree(writer, worldX, groundY, worldZ, rng);
+        } else {
+            placeBoulder(writer, worldX, groundY, worldZ, rng);
+        }
+    }
+
+    return writer.takeOutgoing();
+}
+
+void StructurePlacer::placeTree(Writer& writer, int worldX, int groundY, int worldZ, std::uint64_t& rng) {
+    int trunkHeight = 4 + randomRange(rng, 3);
+    for (int y = 1; y <= trunkHeight; y++) {
+        writer.setSolid(worldX, groundY + y, worldZ);
+    }
+
+    // Two wide layers of leaves around the top of the trunk and a narrow cap
+    for (int layer = trunkHeight - 1; layer <= trunkHeight + 1; layer++) {
+        int radius = layer > trunkHeight ? 1 : MAX_REACH;
+        for (int dx = -radius; dx <= radius; dx++) {
+            for (int dz = -radius; dz <= radius; dz++) {
+                if (std::abs(dx) == MAX_REACH && std::abs(dz) == MAX_REACH) {
+                    continue;
+                }
+                writer.setSolid(worldX + dx, groundY + layer, worldZ + dz);
+            }
+        }
+    }
+}
+
+void StructurePlacer::placeBoulder(Writer& writer, int worldX, int groundY, int worldZ, std::uint64_t& rng) {
+    int radius = 1 + randomRange(rng, MAX_REACH);
+    for (int dx = -radius; dx <= radius; dx++) {
+        for (int dy = -radius; dy <= radius; dy++) {
+            for (int dz = -radius; dz <= radius; dz++) {
+                if (dx * dx + dy * dy + dz * dz <= radius * radius) {
+                    writer.setSolid(worldX + dx, groundY + dy, worldZ + dz);
+                }
+            }
+        }
+    }
+}
+
+void PendingWriteQueue::add(std::pair<int, int> source, std::vector<ChunkWrites> batches) {
+    for (auto& batch : batches) {
+        m_byTarget[batch.target].push_back({source, std::move(batch.writes)});
+    }
+}
+
+void PendingWriteQueue::applyTo(Chunk& target) const {
+    auto it = m_byTarget.find({target.getChunkX(), target.getChunkZ()});
+    if (it == m_byTarget.end()) {
+        return;
+    }
+    for (const auto& batch : it->second) {
+        apply(batch.writes, target);
+    }
+}
+
+void PendingWriteQueue::applyFrom(std::pair<int, int> source, Chunk& target) const {
+    auto it = m_byTarget.find({target.getChunkX(), target.getChunkZ()});
+    if (it == m_byTarget.end()) {
+        return;
+    }
+    for (const auto& batch : it->second) {
+        if (batch.source == source) {
+            apply(batch.writes, target);
+        }
+    }
+}
+
+void PendingWriteQueue::removeSource(std::pair<int, int> source) {
+    // Features reach less than a chunk, so only direct neighbours can hold batches
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            auto it = m_byTarget.find({source.first + dx, source.second + dz});
+            if (it == m_byTarget.end()) {
+                continue;
+            }
+            std::erase_if(it->second, [&](const Batch& batch) { return batch.source == source; });
+            if (it->second.empty()) {
+                m_byTarget.erase(it);
+            }
+        }
+    }
+}
+
+size_t PendingWriteQueue::batchCount() const {
+    size_t count = 0;
+    for (const auto& entry : m_byTarget) {
+        count += entry.second.size();
+    }
+    return count;
+}
+
+void PendingWriteQueue::apply(const std::vector<VoxelWrite>& writes, Chunk& target) {
+    for (const auto& write : writes) {
+        target.setCube(write.x, write.y, write.z, true);
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "chunk.hpp"
+#include "pair_hash.hpp"
+
+// A solid voxel placed by a structure, in the target chunk's local coordinates
+struct VoxelWrite {
+    std::uint8_t x;
+    std::uint8_t z;
+    std::uint16_t y;
+};
+
+// Writes a structure made into one neighbouring chunk
+struct ChunkWrites {
+    std::pair<int, int> target;
+    std::vector<VoxelWrite> writes;
+};
+
+// Places features (trees, boulders) that may extend past the chunk they are
+// seeded in. Placement depends only on the chunk's coordinates and the noise
+// heightmap, and every write only ever sets a voxel solid, so the final world
+// is the same whatever order chunks are generated in.
+class StructurePlacer {
+public:
+    static constexpr std::uint64_t WORLD_SEED = 0x5eed5eed1234abcdull;
+    // Features never reach further than this from their origin column
+    static constexpr int MAX_REACH = 2;
+
+    // Runs on a worker right after generateTerrain(). Writes inside the chunk
+    // are applied directly; the rest are returned grouped by target chunk.
+    static std::vector<ChunkWrites> placeStructures(Chunk& chunk);
+
+private:
+    class Writer;
+
+    static void placeTree(Writer& writer, int worldX, int groundY, int worldZ, std::uint64_t& rng);
+    static void placeBoulder(Writer& writer, int worldX, int groundY, int worldZ, std::uint64_t& rng);
+};
+
+// Cross-chunk writes waiting for their target to be generated. Owned and
+// used only by the thread that owns the ChunkManager. Batches are kept while
+// their source chunk stays loaded, so a target that unloads and regenerates
+// receives them again.
+class PendingWriteQueue {
+public:
+    // Record the writes a freshly generated chunk made into its neighbours
+    void add(std::pair<int, int> source, std::vector<ChunkWrites> batches);
+
+    // Apply every queued batch aimed at this chunk
+    void applyTo(Chunk& target) const;
+
+    // Apply only the batch from one source to one target, if there is one
+    void applyFrom(std::pair<int, int> source, Chunk& target) const;
+
+    // Forget everything a chunk wrote into its neighbours
+    void removeSource(std::pair<int, int> source);
+
+    size_t batchCount() const;
+
+private:
+    struct Batch {
+        std::pair<int, int> source;
+        std::vector<VoxelWrite> writes;
+    };
+
+    std::unordered_map<std::pair<int, int>, std::vector<Batch>, PairHash> m_byTarget;
+
+    static void apply(const std::vector<VoxelWrite>& writes, Chunk& target);
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <type_traits>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+
+// Fixed set of long-lived worker threads. Unlike std::async, workers survive
+// between tasks so their thread_local scratch arenas are reused.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = defaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task; tasks start in submission order
+    template<typename F>
+    auto submit(F task) -> std::future<std::invoke_result_t<F>>;
+
+    // Run body(i) for every i in [0, count) and return once all calls have
+    // finished. The calling thread takes part, so this makes progress even
+    // while the workers are busy with earlier tasks.
+    template<typename F>
+    void parallelFor(size_t count, F body);
+
+    // Run one queued task on the calling thread, if any; lets an otherwise
+    // idle thread help drain a backlog
+    bool tryRunPendingTask();
+
+    size_t size() const { return m_workers.size(); }
+
+    // One worker per hardware thread, leaving one for the main thread
+    static size_t defaultThreadCount();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::move_only_function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+
+    void workerLoop();
+};
+
+template<typename F>
+auto ThreadPool::submit(F task) -> std::future<std::invoke_result_t<F>> {
+    std::packaged_task<std::invoke_result_t<F>()> packaged(std::move(task));
+    auto result = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.emplace_back(std::move(packaged));
+    }
+    m_condition.notify_one();
+    return result;
+}
+
+template<typename F>
+void ThreadPool::parallelFor(size_t count, F body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Helpers may start after the loop has finished, so shared state outlives this call
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        size_t count;
+        F body;
+        State(size_t n, F f) : count(n), body(std::move(f)) {}
+    };
+    auto state = std::make_shared<State>(count, std::move(body));
+
+    auto drain = [](State& shared) {
+        size_t index;
+        while ((index = shared.next.fetch_add(1, std::memory_order_relaxed)) < shared.count) {
+            shared.body(index);
+            shared.done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    size_t helpers = std::min(m_workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        submit([state, drain]() { drain(*state); });
+    }
+
+    drain(*state);
+    while (state->done.load(std::memory_order_acquire) < count) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer triple buffer. The writer fills
+// writeBuffer() and publishes it; the reader picks up the newest published
+// value with update() and reads it via readBuffer(). Neither side ever waits.
+template<typename T>
+class TripleBuffer {
+public:
+    // Writer side: the slot that will be handed over on the next publish()
+    T& writeBuffer() { return m_slots[m_back]; }
+
+    void publish() {
+        int previous = m_middle.exchange(m_back | FRESH_BIT, std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+    }
+
+    // Reader side: swap in the newest published slot. Returns false if
+    // nothing was published since the last call.
+    bool update() {
+        if (!(m_middle.load(std::memory_order_relaxed) & FRESH_BIT)) {
+            return false;
+        }
+        int previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return m_slots[m_front]; }
+
+private:
+    static constexpr int INDEX_MASK = 0x3;
+    static constexpr int FRESH_BIT = 0x4;
+
+    std::array<T, 3> m_slots{};
+    int m_back = 0;
+    std::atomic<int> m_middle{1};
+    int m_front = 2;
+};
@@ -0,0 +1,282 @@
+#include "world_edit.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <unordered_set>
+
+namespace {
+    constexpr int SECTION_HEIGHT = Chunk::SECTION_HEIGHT;
+
+    constexpr char SCHEMATIC_MAGIC[4] = {'V', 'X', 'S', 'C'};
+    constexpr std::uint32_t SCHEMATIC_VERSION = 1;
+    // Refuse to load anything larger than this along any axis
+    constexpr int MAX_SCHEMATIC_SIZE = 1024;
+
+    // Bits first..last (inclusive, 0-31) set
+    std::uint32_t spanMask(int first, int last) {
+        std::uint32_t upTo = last == 31 ? ~0u : (1u << (last + 1)) - 1;
+        return upTo & ~((1u << first) - 1);
+    }
+}
+
+Schematic::Schematic(glm::ivec3 size)
+    : m_size(glm::max(size, glm::ivec3(0))), m_wordsPerRow((m_size.x + 31) / 32),
+      m_words(static_cast<size_t>(m_wordsPerRow) * m_size.y * m_size.z, 0) {}
+
+bool Schematic::get(int x, int y, int z) const {
+    if (x < 0 || x >= m_size.x || y < 0 || y >= m_size.y || z < 0 || z >= m_size.z) {
+        return false;
+    }
+    return (row(y, z)[x / 32] >> (x % 32)) & 1;
+}
+
+void Schematic::set(int x, int y, int z, bool solid) {
+    if (x < 0 || x >= m_size.x || y < 0 || y >= m_size.y || z < 0 || z >= m_size.z) {
+        return;
+    }
+    std::uint32_t& word = row(y, z)[x / 32];
+    std::uint32_t bit = 1u << (x % 32);
+    word = solid ? (word | bit) : (word & ~bit);
+}
+
+std::uint64_t Schematic::solidCount() const {
+    std::uint64_t count = 0;
+    for (std::uint32_t word : m_words) {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+bool Schematic::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    std::int32_t size[3] = {m_size.x, m_size.y, m_size.z};
+    out.write(SCHEMATIC_MAGIC, sizeof(SCHEMATIC_MAGIC));
+    out.write(reinterpret_cast<const char*>(&SCHEMATIC_VERSION), sizeof(SCHEMATIC_VERSION));
+    out.write(reinterpret_cast<const char*>(size), sizeof(size));
+    out.write(reinterpret_cast<const char*>(m_words.data()), m_words.size() * sizeof(std::uint32_t));
+    return static_cast<bool>(out);
+}
+
+std::optional<Schematic> Schematic::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    std::uint32_t version = 0;
+    std::int32_t size[3];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, SCHEMATIC_MAGIC)
+        || !in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != SCHEMATIC_VERSION
+        || !in.read(reinterpret_cast<char*>(size), sizeof(size))) {
+        return std::nullopt;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        if (size[axis] < 0 || size[axis] > MAX_SCHEMATIC_SIZE) {
+            return std::nullopt;
+        }
+    }
+
+    Schematic schematic(glm::ivec3(size[0], size[1], size[2]));
+    std::vector<std::uint32_t>& words = schematic.m_words;
+    if (!in.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(std::uint32_t))) {
+        return std::nullopt;
+    }
+    // Keep the bits past the width clear, whatever the file held
+    int tailBits = schematic.m_size.x % 32;
+    if (tailBits != 0) {
+        for (size_t last = schematic.m_wordsPerRow - 1; last < words.size(); last += schematic.m_wordsPerRow) {
+            words[last] &= (1u << tailBits) - 1;
+        }
+    }
+    return schematic;
+}
+
+WorldEdit::WorldEdit(ChunkManager& chunkManager) : m_chunkManager(chunkManager) {}
+
+void WorldEdit::fillBox(glm::ivec3 minCorner, glm::ivec3 maxCorner, bool solid) {
+    for (int y = minCorner.y; y <= maxCorner.y; y++) {
+        for (int z = minCorner.z; z <= maxCorner.z; z++) {
+            writeSpan(y, z, minCorner.x, maxCorner.x, solid);
+        }
+    }
+}
+
+void WorldEdit::fillSphere(glm::ivec3 center, int radius, bool solid) {
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dz = -radius; dz <= radius; dz++) {
+            int remaining = radius * radius - dy * dy - dz * dz;
+            if (remaining < 0) {
+                continue;
+            }
+            // Each row through a sphere is a single span
+            int halfWidth = static_cast<int>(std::sqrt(static_cast<float>(remaining)));
+            writeSpan(center.y + dy, center.z + dz, center.x - halfWidth, center.x + halfWidth, solid);
+        }
+    }
+}
+
+void WorldEdit::paste(const Schematic& schematic, glm::ivec3 origin) {
+    glm::ivec3 size = schematic.size();
+    for (int y = 0; y < size.y; y++) {
+        if (origin.y + y < 0 || origin.y + y >= Chunk::CHUNK_HEIGHT) {
+            continue;
+        }
+        for (int z = 0; z < size.z; z++) {
+            const std::uint32_t* words = schematic.row(y, z);
+            for (int word = 0; word < schematic.wordsPerRow(); word++) {
+                std::uint32_t bits = words[word];
+                if (bits == 0) {
+                    continue;
+                }
+                // A schematic word straddles at most two chunk rows
+                int worldX = origin.x + word * 32;
+                int chunkX = Chunk::worldToChunkX(worldX);
+                int shift = worldX - chunkX * Chunk::CHUNK_WIDTH;
+                writeBits(chunkX, origin.y + y, origin.z + z, bits << shift, bits << shift);
+                if (shift != 0) {
+                    writeBits(chunkX + 1, origin.y + y, origin.z + z, bits >> (32 - shift), bits >> (32 - shift));
+                }
+            }
+        }
+    }
+}
+
+Schematic WorldEdit::copy(glm::ivec3 minCorner, glm::ivec3 maxCorner) const {
+    Schematic schematic(maxCorner - minCorner + glm::ivec3(1));
+    glm::ivec3 size = schematic.size();
+    auto chunkRow = [this](int chunkX, int y, int z) -> std::uint32_t {
+        int chunkZ = Chunk::worldToChunkZ(z);
+        const Chunk* chunk = m_chunkManager.getReadyChunk(chunkX, chunkZ);
+        return chunk ? chunk->getRow(y, z - chunkZ * Chunk::CHUNK_DEPTH) : 0;
+    };
+
+    int tailBits = size.x % 32;
+    for (int y = 0; y < size.y; y++) {
+        for (int z = 0; z < size.z; z++) {
+            std::uint32_t* words = schematic.row(y, z);
+            for (int word = 0; word < schematic.wordsPerRow(); word++) {
+                int worldX = minCorner.x + word * 32;
+                int chunkX = Chunk::worldToChunkX(worldX);
+                int shift = worldX - chunkX * Chunk::CHUNK_WIDTH;
+                std::uint32_t bits = chunkRow(chunkX, minCorner.y + y, minCorner.z + z) >> shift;
+                if (shift != 0) {
+                    bits |= chunkRow(chunkX + 1, minCorner.y + y, minCorner.z + z) << (32 - shift);
+                }
+                if (word == schematic.wordsPerRow() - 1 && tailBits != 0) {
+                    bits &= (1u << tailBits) - 1;
+                }
+                words[word] = bits;
+            }
+        }
+    }
+    return schematic;
+}
+
+EditStats WorldEdit::commit() {
+    auto start = std::chrono::steady_clock::now();
+    EditStats stats;
+    glm::ivec3 minCorner(INT_MAX);
+    glm::ivec3 maxCorner(INT_MIN);
+    std::unordered_set<SectionKey, SectionKeyHash> remeshed;
+
+    for (const auto& [key, rows] : m_sections) {
+        Chunk* chunk = m_chunkManager.getReadyChunk(key.chunkX, key.chunkZ);
+        if (!chunk) {
+            continue;
+        }
+
+        int firstY = key.section * SECTION_HEIGHT;
+        bool changedAny = false;
+        // Which borders of the section had voxels change
+        bool below = false, above = false, west = false, east = false, north = false, south = false;
+        for (const RowWrite& write : rows) {
+            int layer = write.row / Chunk::CHUNK_DEPTH;
+            int z = write.row % Chunk::CHUNK_DEPTH;
+            std::uint32_t changed = chunk->writeRow(firstY + layer, z, write.mask, write.cubes);
+            stats.voxelsWritten += std::popcount(write.mask);
+            if (changed == 0) {
+                continue;
+            }
+
+            stats.voxelsChanged += std::popcount(changed);
+            changedAny = true;
+            below |= layer == 0;
+            above |= layer == SECTION_HEIGHT - 1;
+            west |= (changed & 1) != 0;
+            east |= (changed >> 31) != 0;
+            north |= z == 0;
+            south |= z == Chunk::CHUNK_DEPTH - 1;
+
+            glm::ivec3 base(key.chunkX * Chunk::CHUNK_WIDTH, firstY + layer, key.chunkZ * Chunk::CHUNK_DEPTH + z);
+            minCorner = glm::min(minCorner, base + glm::ivec3(std::countr_zero(changed), 0, 0));
+            maxCorner = glm::max(maxCorner, base + glm::ivec3(31 - std::countl_zero(changed), 0, 0));
+        }
+        if (!changedAny) {
+            continue;
+        }
+        stats.sectionsEdited++;
+        remeshed.insert(key);
+        chunk->markSectionDirty(key.section);
+
+        // Meshes sample one cube past their section, so bordering sections may change too
+        for (int dx = west ? -1 : 0; dx <= (east ? 1 : 0); dx++) {
+            for (int dz = north ? -1 : 0; dz <= (south ? 1 : 0); dz++) {
+                Chunk* target = (dx == 0 && dz == 0) ? chunk : m_chunkManager.getReadyChunk(key.chunkX + dx, key.chunkZ + dz);
+                if (!target) {
+                    continue;
+                }
+                for (int section = key.section - (below ? 1 : 0); section <= key.section + (above ? 1 : 0); section++) {
+                    if (section < 0 || section >= Chunk::SECTION_COUNT) {
+                        continue;
+                    }
+                    if (remeshed.insert({key.chunkX + dx, section, key.chunkZ + dz}).second) {
+                        target->markCubesDirty(section);
+                    }
+                }
+            }
+        }
+    }
+
+    discard();
+    stats.sectionsRemeshed = static_cast<int>(remeshed.size());
+    if (stats.voxelsChanged > 0) {
+        stats.minCorner = minCorner;
+        stats.maxCorner = maxCorner;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void WorldEdit::discard() {
+    m_sections.clear();
+    m_lastRows = nullptr;
+}
+
+void WorldEdit::writeSpan(int y, int z, int minX, int maxX, bool solid) {
+    if (y < 0 || y >= Chunk::CHUNK_HEIGHT || minX > maxX) {
+        return;
+    }
+    for (int chunkX = Chunk::worldToChunkX(minX); chunkX <= Chunk::worldToChunkX(maxX); chunkX++) {
+        int first = std::max(minX - chunkX * Chunk::CHUNK_WIDTH, 0);
+        int last = std::min(maxX - chunkX * Chunk::CHUNK_WIDTH, Chunk::CHUNK_WIDTH - 1);
+        std::uint32_t mask = spanMask(first, last);
+        writeBits(chunkX, y, z, mask, solid ? mask : 0);
+    }
+}
+
+void WorldEdit::writeBits(int chunkX, int y, int z, std::uint32_t mask, std::uint32_t cubes) {
+    if (mask == 0) {
+        return;
+    }
+    int chunkZ = Chunk::worldToChunkZ(z);
+    SectionKey key{chunkX, y / SECTION_HEIGHT, chunkZ};
+    if (!m_lastRows || !(key == m_lastKey)) {
+        m_lastKey = key;
+        m_lastRows = &m_sections[key];
+    }
+    int row = (z - chunkZ * Chunk::CHUNK_DEPTH) + (y % SECTION_HEIGHT) * Chunk::CHUNK_DEPTH;
+    m_lastRows->push_back({static_cast<std::uint16_t>(row), mask, cubes});
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "chunk_manager.hpp"
+#include "section_key.hpp"
+
+// A box of voxels copied from the world (or built in code) that can be pasted
+// elsewhere. Stored like chunk voxels: one bitmask per row along x, split into
+// 32-bit words.
+class Schematic {
+public:
+    explicit Schematic(glm::ivec3 size = glm::ivec3(0));
+
+    glm::ivec3 size() const { return m_size; }
+    int wordsPerRow() const { return m_wordsPerRow; }
+
+    bool get(int x, int y, int z) const;
+    void set(int x, int y, int z, bool solid);
+    // Bit x % 32 of word x / 32; bits past the width are always clear
+    std::uint32_t* row(int y, int z) { return &m_words[(z + y * m_size.z) * m_wordsPerRow]; }
+    const std::uint32_t* row(int y, int z) const { return &m_words[(z + y * m_size.z) * m_wordsPerRow]; }
+    std::uint64_t solidCount() const;
+
+    // Binary file: magic, version, size, then the row words
+    bool save(const std::string& path) const;
+    static std::optional<Schematic> load(const std::string& path);
+
+private:
+    glm::ivec3 m_size;
+    int m_wordsPerRow;
+    std::vector<std::uint32_t> m_words;
+};
+
+// Totals for one committed batch of edits
+struct EditStats {
+    // Voxels covered by the edits in loaded chunks, and how many of those changed
+    std::uint64_t voxelsWritten = 0;
+    std::uint64_t voxelsChanged = 0;
+    int sectionsEdited = 0;
+    // Edited sections plus bordering ones whose meshes sample them
+    int sectionsRemeshed = 0;
+    double seconds = 0.0;
+    // Bounds of the changed voxels (world coordinates, inclusive), valid when any changed
+    glm::ivec3 minCorner{};
+    glm::ivec3 maxCorner{};
+};
+
+// Bulk voxel edits in world coordinates, across chunks. Edits are recorded as
+// row span writes grouped by chunk section and only reach the world on
+// commit(), which applies each section's rows with word-level writes and then
+// marks every affected section dirty once, so each is remeshed a single time.
+// Owned and used only by the thread that owns the ChunkManager.
+class WorldEdit {
+public:
+    explicit WorldEdit(ChunkManager& chunkManager);
+
+    // Set every voxel in the box (inclusive) solid or clear it
+    void fillBox(glm::ivec3 minCorner, glm::ivec3 maxCorner, bool solid);
+    void fillSphere(glm::ivec3 center, int radius, bool solid);
+    // Place the schematic's solid voxels with its minimum corner at origin; its air leaves the world as is
+    void paste(const Schematic& schematic, glm::ivec3 origin);
+
+    // Read a box (inclusive) of the world; chunks that are not ready read as air
+    Schematic copy(glm::ivec3 minCorner, glm::ivec3 maxCorner) const;
+
+    bool empty() const { return m_sections.empty(); }
+    // Apply everything recorded since the last commit. Edits to chunks that
+    // are not ready are dropped.
+    EditStats commit();
+    void discard();
+
+private:
+    // Span write to one row of a section; row = z + layer * CHUNK_DEPTH
+    struct RowWrite {
+        std::uint16_t row;
+        std::uint32_t mask;
+        std::uint32_t cubes;
+    };
+
+    ChunkManager& m_chunkManager;
+    std::unordered_map<SectionKey, std::vector<RowWrite>, SectionKeyHash> m_sections;
+    // Consecutive writes usually hit the same section, so skip the lookup
+    SectionKey m_lastKey{};
+    std::vector<RowWrite>* m_lastRows = nullptr;
+
+    // Record x in [minX, maxX] of a world row as solid or air
+    void writeSpan(int y, int z, int minX, int maxX, bool solid);
+    // Record the masked bits of one chunk's row (y and z in world coordinates)
+    void writeBits(int chunkX, int y, int z, std::uint32_t mask, std::uint32_t cubes);
+};
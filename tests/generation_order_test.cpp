@@ -0,0 +1,110 @@
+// Loads the same chunk window along several paths and checks that the chunks
+// in its interior end up with identical voxels. Structures cross chunk borders
+// through the deferred write queue, so the order chunks finish generating in
+// must not change the world. Runs without a window or GL context.
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chunk_manager.hpp"
+
+namespace {
+    // Chunks one or more away from the window's edge get every structure
+    // write that can reach them from chunks inside the window
+    constexpr int INTERIOR_MIN = -ChunkManager::CHUNK_SIZE / 2 + 1;
+    constexpr int INTERIOR_MAX = ChunkManager::CHUNK_SIZE - ChunkManager::CHUNK_SIZE / 2 - 2;
+
+    using Rows = std::vector<std::uint32_t>;
+
+    void waitUntilLoaded(ChunkManager& manager) {
+        while (!manager.isFullyLoaded()) {
+            if (manager.pollGeneratedChunks().empty()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Every row of every interior chunk of the window at (0, 0)
+    std::vector<Rows> interiorRows(const ChunkManager& manager) {
+        std::vector<Rows> chunks;
+        for (int chunkX = INTERIOR_MIN; chunkX <= INTERIOR_MAX; chunkX++) {
+            for (int chunkZ = INTERIOR_MIN; chunkZ <= INTERIOR_MAX; chunkZ++) {
+                const Chunk* chunk = manager.getReadyChunk(chunkX, chunkZ);
+                Rows rows;
+                if (chunk) {
+                    for (int y = 0; y < Chunk::CHUNK_HEIGHT; y++) {
+                        for (int z = 0; z < Chunk::CHUNK_DEPTH; z++) {
+                            rows.push_back(chunk->getRow(y, z));
+                        }
+                    }
+                }
+                chunks.push_back(std::move(rows));
+            }
+        }
+        return chunks;
+    }
+
+    std::vector<Rows> loadDirect() {
+        ChunkManager manager;
+        manager.updateChunks(0, 0);
+        waitUntilLoaded(manager);
+        return interiorRows(manager);
+    }
+
+    // Slide the window in from `steps` chunks away, polling at irregular
+    // intervals so chunks finish in a different order on each step
+    std::vector<Rows> loadSliding(int stepX, int stepZ, int steps, unsigned seed) {
+        ChunkManager manager;
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> pause(0, 3);
+        for (int step = steps; step >= 0; step--) {
+            manager.updateChunks(step * stepX, step * stepZ);
+            for (int poll = pause(random); poll > 0; poll--) {
+                manager.pollGeneratedChunks();
+                std::this_thread::sleep_for(std::chrono::microseconds(200 * pause(random)));
+            }
+        }
+        waitUntilLoaded(manager);
+        return interiorRows(manager);
+    }
+}
+
+int main() {
+    Chunk::initializeNoise();
+
+    std::vector<Rows> expected = loadDirect();
+    for (const Rows& rows : expected) {
+        if (rows.empty()) {
+            std::cerr << "Direct load left an interior chunk unready" << std::endl;
+            return 1;
+        }
+    }
+
+    struct Path {
+        std::string name;
+        std::vector<Rows> chunks;
+    };
+    std::vector<Path> paths;
+    paths.push_back({"sliding in from +x", loadSliding(1, 0, 8, 1)});
+    paths.push_back({"sliding in from -z", loadSliding(0, -1, 7, 2)});
+    paths.push_back({"sliding in diagonally", loadSliding(-1, 1, 5, 3)});
+
+    int failures = 0;
+    for (const Path& path : paths) {
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (path.chunks[i] != expected[i]) {
+                int chunkX = INTERIOR_MIN + static_cast<int>(i) / (INTERIOR_MAX - INTERIOR_MIN + 1);
+                int chunkZ = INTERIOR_MIN + static_cast<int>(i) % (INTERIOR_MAX - INTERIOR_MIN + 1);
+                std::cerr << "Chunk (" << chunkX << ", " << chunkZ << ") differs after " << path.name << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    std::cout << expected.size() << " interior chunks compared across " << paths.size() + 1 << " load paths, "
+              << failures << " mismatches" << std::endl;
+    return failures == 0 ? 0 : 1;
+}